@@ -21,46 +21,105 @@
 
 #include "capstone_bridge.h"
 
+static XDisasmAbstract::RELTYPE _getBranchRelType(const XDisasmAbstract::DISASM_RESULT &disasmResult)
+{
+    XDisasmAbstract::RELTYPE result = XDisasmAbstract::RELTYPE_JMP;
+
+    if (disasmResult.bIsCall) {
+        result = XDisasmAbstract::RELTYPE_CALL;
+    } else if (disasmResult.bIsJmp) {
+        result = XDisasmAbstract::RELTYPE_JMP_UNCOND;
+    } else if (disasmResult.bIsCondJmp) {
+        result = XDisasmAbstract::RELTYPE_JMP_COND;
+    }
+
+    return result;
+}
+
 Capstone_Bridge::Capstone_Bridge(XBinary::DM disasmMode, XBinary::SYNTAX syntax, QObject *pParent) : XDisasmAbstract(pParent)
 {
+    m_handle = 0;
+    m_pInsn = nullptr;
+    m_handleNoDetail = 0;
+    m_pInsnNoDetail = nullptr;
+
     XCapstone::openHandle(disasmMode, &m_handle, true, syntax);
 
+    if (m_handle) {
+        m_pInsn = cs_malloc(m_handle);
+    }
+
     m_disasmMode = disasmMode;
     m_disasmFamily = XBinary::getDisasmFamily(disasmMode);
+    m_opcodeClassTable = getOpcodeClassTable(m_disasmFamily);
     m_syntax = syntax;
 }
 
 Capstone_Bridge::~Capstone_Bridge()
 {
+    if (m_pInsn) {
+        cs_free(m_pInsn, 1);
+    }
+
     if (m_handle) {
         XCapstone::closeHandle(&m_handle);
     }
+
+    if (m_pInsnNoDetail) {
+        cs_free(m_pInsnNoDetail, 1);
+    }
+
+    if (m_handleNoDetail) {
+        XCapstone::closeHandle(&m_handleNoDetail);
+    }
 }
 
-QList<XDisasmAbstract::DISASM_RESULT> Capstone_Bridge::_disasm(char *pData, qint32 nDataSize, XADDR nAddress, const DISASM_OPTIONS &disasmOptions, qint32 nLimit,
-                                                               XBinary::PDSTRUCT *pPdStruct)
+bool Capstone_Bridge::_openNoDetailHandle()
 {
-    QList<XDisasmAbstract::DISASM_RESULT> listResult;
+    if (m_handleNoDetail == 0) {
+        XCapstone::openHandle(m_disasmMode, &m_handleNoDetail, false, m_syntax);
+
+        if (m_handleNoDetail) {
+            m_pInsnNoDetail = cs_malloc(m_handleNoDetail);
+        }
+    }
 
+    return (m_handleNoDetail != 0) && (m_pInsnNoDetail != nullptr);
+}
+
+void Capstone_Bridge::_disasm(char *pData, qint32 nDataSize, XADDR nAddress, const DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink, XBinary::PDSTRUCT *pPdStruct)
+{
     STATE state = {};
     state.nCurrentCount = 0;
     state.nCurrentOffset = 0;
-    state.nLimit = nLimit;
     state.nMaxSize = nDataSize;
     state.nAddress = nAddress;
+    state.dmFamily = m_disasmFamily;
+    state.syntax = m_syntax;
 
-    if (m_handle == 0) {
-        // The disassembler failed to initialize (unsupported/misconfigured mode). Return an empty
-        // list instead of emitting the whole buffer as a stream of bogus 'db' bytes.
-        return listResult;
+    if ((m_handle == 0) || (m_pInsn == nullptr)) {
+        // The disassembler failed to initialize (unsupported/misconfigured mode). Emit nothing
+        // instead of the whole buffer as a stream of bogus 'db' bytes.
+        return;
+    }
+
+    // m_pInsn (with its detail block) was allocated once in the constructor; cs_disasm_iter decodes into it,
+    // so the sweep does no heap allocation per instruction in the Capstone layer.
+    csh handle = m_handle;
+    cs_insn *pInsn = m_pInsn;
+    bool bDetail = true;
+
+    // Boundary-only passes (sizes, flow flags) run on a second handle opened without CS_OPT_DETAIL.
+    if (disasmOptions.bLengthOnly && disasmOptions.bNoXrefs && _openNoDetailHandle()) {
+        handle = m_handleNoDetail;
+        pInsn = m_pInsnNoDetail;
+        bDetail = false;
     }
 
     while (XBinary::isPdStructNotCanceled(pPdStruct) && (!(state.bIsStop))) {
         XDisasmAbstract::DISASM_RESULT result = {};
         result.nAddress = nAddress;
 
-        cs_insn *pInsn = nullptr;
-
         // cs_reg_name
 
         // pData advances by result.nSize each iteration while nDataSize stays constant, so the number of
@@ -72,43 +131,64 @@ QList<XDisasmAbstract::DISASM_RESULT> Capstone_Bridge::_disasm(char *pData, qint
             break;
         }
 
-        quint64 nNumberOfOpcodes = cs_disasm(m_handle, (uint8_t *)pData, nRemaining, nAddress, 1, &pInsn);
+        // cs_disasm_iter advances its own copies of the cursor; pData/nAddress are still advanced below by result.nSize.
+        const uint8_t *pCode = (const uint8_t *)pData;
+        size_t nCodeSize = (size_t)nRemaining;
+        uint64_t nCodeAddress = nAddress;
+
+        if (cs_disasm_iter(handle, &pCode, &nCodeSize, &nCodeAddress, pInsn)) {
+            quint16 nOpcodeClass = getOpcodeClass(m_opcodeClassTable, pInsn->id);
 
-        if (nNumberOfOpcodes > 0) {
             result.bIsValid = true;
-            result.bIsRet = isRetOpcode(m_disasmFamily, pInsn->id);
-            result.bIsCall = isCallOpcode(m_disasmFamily, pInsn->id);
-            result.bIsJmp = isJumpOpcode(m_disasmFamily, pInsn->id);
-            result.bIsCondJmp = isCondJumpOpcode(m_disasmFamily, pInsn->id);
+            result.bIsRet = (nOpcodeClass & OPCODECLASS_RET) != 0;
+            result.bIsCall = (nOpcodeClass & OPCODECLASS_CALL) != 0;
+            result.bIsJmp = (nOpcodeClass & OPCODECLASS_JMP) != 0;
+            result.bIsCondJmp = (nOpcodeClass & OPCODECLASS_CONDJMP) != 0;
             result.nOpcode = pInsn->id;
-            result.sMnemonic = pInsn->mnemonic;
-            result.sOperands = pInsn->op_str;
             result.nSize = pInsn->size;
             result.nNextAddress = nAddress + result.nSize;
 
-            if (m_disasmFamily == XBinary::DMFAMILY_X86) {
+            if (!disasmOptions.bLengthOnly) {
+                result.sMnemonic = pInsn->mnemonic;
+                result.sOperands = pInsn->op_str;
+            }
+
+            // pInsn->detail is not allocated on the detail-less handle
+            qint32 nNumberOfGroups = bDetail ? pInsn->detail->groups_count : 0;
+
+            if (bDetail && (m_disasmFamily == XBinary::DMFAMILY_X86)) {
                 result.nDispOffset = pInsn->detail->x86.encoding.disp_offset;
                 result.nDispSize = pInsn->detail->x86.encoding.disp_size;
                 result.nImmOffset = pInsn->detail->x86.encoding.imm_offset;
                 result.nImmSize = pInsn->detail->x86.encoding.imm_size;
             }
 
+            // Capstone gives b<cond> (ARM) and b.<cond> (ARM64) the id of B, which the opcode table classes as JMP;
+            // only the condition code tells them apart
+            if (bDetail && result.bIsJmp) {
+                bool bIsCondition = false;
+
+                if (m_disasmFamily == XBinary::DMFAMILY_ARM) {
+                    bIsCondition = (pInsn->detail->arm.cc != ARM_CC_INVALID) && (pInsn->detail->arm.cc != ARM_CC_AL);
+                } else if (m_disasmFamily == XBinary::DMFAMILY_ARM64) {
+                    bIsCondition = (pInsn->detail->arm64.cc != ARM64_CC_INVALID) && (pInsn->detail->arm64.cc != ARM64_CC_AL) &&
+                                   (pInsn->detail->arm64.cc != ARM64_CC_NV);
+                }
+
+                if (bIsCondition) {
+                    result.bIsJmp = false;
+                    result.bIsCondJmp = true;
+                }
+            }
+
             // Relatives
-            for (qint32 i = 0; i < pInsn->detail->groups_count; i++) {
+            for (qint32 i = 0; i < nNumberOfGroups; i++) {
                 if (pInsn->detail->groups[i] == CS_GRP_BRANCH_RELATIVE) {
                     if (m_disasmFamily == XBinary::DMFAMILY_X86) {
                         for (qint32 j = 0; j < pInsn->detail->x86.op_count; j++) {
                             // TODO mb use groups
                             if (pInsn->detail->x86.operands[j].type == X86_OP_IMM) {
-                                if (result.bIsCall) {
-                                    result.relType = XDisasmAbstract::RELTYPE_CALL;
-                                } else if (result.bIsJmp) {
-                                    result.relType = XDisasmAbstract::RELTYPE_JMP_UNCOND;
-                                } else if (result.bIsCondJmp) {
-                                    result.relType = XDisasmAbstract::RELTYPE_JMP_COND;
-                                } else {
-                                    result.relType = XDisasmAbstract::RELTYPE_JMP;
-                                }
+                                result.relType = _getBranchRelType(result);
 
                                 result.nXrefToRelative = pInsn->detail->x86.operands[j].imm;
                                 result.nNextAddress = result.nXrefToRelative;
@@ -120,7 +200,7 @@ QList<XDisasmAbstract::DISASM_RESULT> Capstone_Bridge::_disasm(char *pData, qint
                     } else if (m_disasmFamily == XBinary::DMFAMILY_ARM) {
                         for (qint32 j = 0; j < pInsn->detail->arm.op_count; j++) {
                             if (pInsn->detail->arm.operands[j].type == ARM_OP_IMM) {
-                                result.relType = XDisasmAbstract::RELTYPE_JMP;  // TODO
+                                result.relType = _getBranchRelType(result);
                                 result.nXrefToRelative = pInsn->detail->arm.operands[j].imm;
                                 result.nNextAddress = result.nXrefToRelative;
                                 result.bIsConst = true;
@@ -131,7 +211,7 @@ QList<XDisasmAbstract::DISASM_RESULT> Capstone_Bridge::_disasm(char *pData, qint
                     } else if (m_disasmFamily == XBinary::DMFAMILY_ARM64) {
                         for (qint32 j = 0; j < pInsn->detail->arm64.op_count; j++) {
                             if (pInsn->detail->arm64.operands[j].type == ARM64_OP_IMM) {
-                                result.relType = XDisasmAbstract::RELTYPE_JMP;  // TODO
+                                result.relType = _getBranchRelType(result);
                                 result.nXrefToRelative = pInsn->detail->arm64.operands[j].imm;
                                 result.nNextAddress = result.nXrefToRelative;
                                 result.bIsConst = true;
@@ -146,7 +226,7 @@ QList<XDisasmAbstract::DISASM_RESULT> Capstone_Bridge::_disasm(char *pData, qint
             }
 
             // Memory
-            if (m_disasmFamily == XBinary::DMFAMILY_X86) {
+            if (bDetail && (m_disasmFamily == XBinary::DMFAMILY_X86)) {
                 for (qint32 i = 0; i < pInsn->detail->x86.op_count; i++) {
                     if (pInsn->detail->x86.operands[i].type == X86_OP_MEM) {
                         bool bLEA = (pInsn->id == X86_INS_LEA);
@@ -191,7 +271,7 @@ QList<XDisasmAbstract::DISASM_RESULT> Capstone_Bridge::_disasm(char *pData, qint
                                 }
                             }
 
-                            if (sOldString != "") {
+                            if ((sOldString != "") && (!disasmOptions.bLengthOnly)) {
                                 sNewString = getNumberString(result.nXrefToMemory, m_disasmMode, m_syntax);
                                 result.sOperands = result.sOperands.replace(sOldString, sNewString);
                             }
@@ -212,37 +292,39 @@ QList<XDisasmAbstract::DISASM_RESULT> Capstone_Bridge::_disasm(char *pData, qint
             //                    }
             //                }
             //            }
-
-            cs_free(pInsn, nNumberOfOpcodes);
         } else {
-            if (cs_errno(m_handle) == CS_ERR_MEM) {
+            if (cs_errno(handle) == CS_ERR_MEM) {
                 // Not enough bytes remain to decode a full instruction: stop cleanly at the memory
                 // boundary rather than fabricating a bogus 'db'/'Invalid opcode' for the truncated tail.
                 result.bMemError = true;
                 state.bIsStop = true;
-            } else if (m_disasmFamily == XBinary::DMFAMILY_ARM) {
-                result.sMnemonic = tr("Invalid opcode");
-                // A32 has a fixed 4-byte instruction width. DMFAMILY_ARM only ever means DM_ARM_LE/DM_ARM_BE
-                // (Thumb maps to a different family), so advancing by 2 would desync onto a mid-word boundary.
-                result.nSize = 4;
-            } else if (m_disasmFamily == XBinary::DMFAMILY_ARM64) {
-                result.sMnemonic = tr("Invalid opcode");
-                result.nSize = 4;
-            } else if (m_disasmFamily == XBinary::DMFAMILY_M68K) {
-                result.sMnemonic = tr("Invalid opcode");
-                result.nSize = 2;
             } else {
-                result.sMnemonic = "db";
-                result.sOperands = getNumberString(*((uint8_t *)pData), m_disasmMode, m_syntax);
-                result.nSize = 1;
+                if (m_disasmFamily == XBinary::DMFAMILY_ARM) {
+                    // A32 has a fixed 4-byte instruction width. DMFAMILY_ARM only ever means DM_ARM_LE/DM_ARM_BE
+                    // (Thumb maps to a different family), so advancing by 2 would desync onto a mid-word boundary.
+                    result.nSize = 4;
+                } else if (m_disasmFamily == XBinary::DMFAMILY_ARM64) {
+                    result.nSize = 4;
+                } else if (m_disasmFamily == XBinary::DMFAMILY_M68K) {
+                    result.nSize = 2;
+                } else {
+                    result.nSize = 1;
+                }
+
+                if (!disasmOptions.bLengthOnly) {
+                    if (result.nSize == 1) {
+                        result.sMnemonic = "db";
+                        result.sOperands = getNumberString(*((uint8_t *)pData), m_disasmMode, m_syntax);
+                    } else {
+                        result.sMnemonic = tr("Invalid opcode");
+                    }
+                }
             }
         }
 
-        _addDisasmResult(&listResult, result, &state, disasmOptions);
+        _addDisasmResult(pSink, result, &state, disasmOptions);
 
         pData += result.nSize;
         nAddress += result.nSize;
     }
-
-    return listResult;
 }
@@ -31,13 +31,20 @@ public:
     explicit Capstone_Bridge(XBinary::DM disasmMode, XBinary::SYNTAX syntax = XBinary::SYNTAX_DEFAULT, QObject *pParent = nullptr);
     ~Capstone_Bridge();
 
-    virtual QList<DISASM_RESULT> _disasm(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, qint32 nLimit,
-                                         XBinary::PDSTRUCT *pPdStruct);
+    virtual void _disasm(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink,
+                         XBinary::PDSTRUCT *pPdStruct);
+
+private:
+    bool _openNoDetailHandle();
 
 private:
     csh m_handle;
+    cs_insn *m_pInsn;  // Reused by cs_disasm_iter for every instruction of a sweep
+    csh m_handleNoDetail;  // Opened on first bLengthOnly + bNoXrefs request
+    cs_insn *m_pInsnNoDetail;
     XBinary::DM m_disasmMode;
     XBinary::DMFAMILY m_disasmFamily;
+    OPCODECLASS_TABLE m_opcodeClassTable;
     XBinary::SYNTAX m_syntax;
 };
 
@@ -27,20 +27,20 @@ X7Zip_Properties::X7Zip_Properties(QObject *pParent) : XDisasmAbstract(pParent)
 {
 }
 
-void X7Zip_Properties::_addTagId(QList<DISASM_RESULT> *pListResults, quint64 nValue, XSevenZip::EIdEnum id, STATE *pState, const DISASM_OPTIONS &disasmOptions)
+void X7Zip_Properties::_addTagId(XDisasmSink *pSink, quint64 nValue, XSevenZip::EIdEnum id, STATE *pState, const DISASM_OPTIONS &disasmOptions)
 {
     if (pState->bIsStop) {
         return;
     }
 
     if (nValue == id) {
-        _addDisasmResult(pListResults, pState->nAddress + pState->nCurrentOffset, 1, XSevenZip::idToSring(id), "", pState, disasmOptions);
+        _addDisasmResult(pSink, pState->nAddress + pState->nCurrentOffset, 1, XSevenZip::idToSring(id), "", pState, disasmOptions);
     } else {
         pState->bIsStop = true;
     }
 }
 
-void X7Zip_Properties::_handleTag(QList<DISASM_RESULT> *pListResults, char *pData, XSevenZip::EIdEnum id, STATE *pState, const DISASM_OPTIONS &disasmOptions)
+void X7Zip_Properties::_handleTag(XDisasmSink *pSink, char *pData, XSevenZip::EIdEnum id, STATE *pState, const DISASM_OPTIONS &disasmOptions)
 {
     if (pState->bIsStop) {
         return;
@@ -50,37 +50,37 @@ void X7Zip_Properties::_handleTag(QList<DISASM_RESULT> *pListResults, char *pDat
 
     if (puTag.bIsValid) {
         if (id == puTag.nValue) {
-            _addTagId(pListResults, puTag.nValue, id, pState, disasmOptions);
+            _addTagId(pSink, puTag.nValue, id, pState, disasmOptions);
             if (puTag.nValue == XSevenZip::k7zIdHeader) {
-                _handleTag(pListResults, pData, XSevenZip::k7zIdMainStreamsInfo, pState, disasmOptions);
-                _handleTag(pListResults, pData, XSevenZip::k7zIdFilesInfo, pState, disasmOptions);
+                _handleTag(pSink, pData, XSevenZip::k7zIdMainStreamsInfo, pState, disasmOptions);
+                _handleTag(pSink, pData, XSevenZip::k7zIdFilesInfo, pState, disasmOptions);
             } else if (puTag.nValue == XSevenZip::k7zIdMainStreamsInfo) {
-                _handleTag(pListResults, pData, XSevenZip::k7zIdPackInfo, pState, disasmOptions);
-                _handleTag(pListResults, pData, XSevenZip::k7zIdUnpackInfo, pState, disasmOptions);
+                _handleTag(pSink, pData, XSevenZip::k7zIdPackInfo, pState, disasmOptions);
+                _handleTag(pSink, pData, XSevenZip::k7zIdUnpackInfo, pState, disasmOptions);
                 XBinary::PACKED_UINT puExtra = XBinary::_read_packedNumber(pData + pState->nCurrentOffset, pState->nMaxSize - pState->nCurrentOffset);
                 if (puExtra.bIsValid) {
                     if (puExtra.nValue == XSevenZip::k7zIdSubStreamsInfo) {
-                        _handleTag(pListResults, pData, XSevenZip::k7zIdSubStreamsInfo, pState, disasmOptions);
+                        _handleTag(pSink, pData, XSevenZip::k7zIdSubStreamsInfo, pState, disasmOptions);
                     }
                 }
-                _handleTag(pListResults, pData, XSevenZip::k7zIdEnd, pState, disasmOptions);
+                _handleTag(pSink, pData, XSevenZip::k7zIdEnd, pState, disasmOptions);
             } else if (puTag.nValue == XSevenZip::k7zIdEncodedHeader) {
-                _handleTag(pListResults, pData, XSevenZip::k7zIdPackInfo, pState, disasmOptions);
-                _handleTag(pListResults, pData, XSevenZip::k7zIdUnpackInfo, pState, disasmOptions);
-                _handleTag(pListResults, pData, XSevenZip::k7zIdEnd, pState, disasmOptions);
+                _handleTag(pSink, pData, XSevenZip::k7zIdPackInfo, pState, disasmOptions);
+                _handleTag(pSink, pData, XSevenZip::k7zIdUnpackInfo, pState, disasmOptions);
+                _handleTag(pSink, pData, XSevenZip::k7zIdEnd, pState, disasmOptions);
             } else if (puTag.nValue == XSevenZip::k7zIdPackInfo) {
-                _handleNumber(pListResults, pData, pState, disasmOptions);                   // Pack Position
-                quint64 nCount = _handleNumber(pListResults, pData, pState, disasmOptions);  // Count of Pack Streams, NUMBER
+                _handleNumber(pSink, pData, pState, disasmOptions);                   // Pack Position
+                quint64 nCount = _handleNumber(pSink, pData, pState, disasmOptions);  // Count of Pack Streams, NUMBER
                 for (quint64 i = 0; (i < nCount) && (!(pState->bIsStop)); i++) {
-                    _handleNumber(pListResults, pData, pState, disasmOptions);  // Size
+                    _handleNumber(pSink, pData, pState, disasmOptions);  // Size
                 }
                 for (quint64 i = 0; (i < nCount) && (!(pState->bIsStop)); i++) {
-                    _handleNumber(pListResults, pData, pState, disasmOptions);  // CRC // Check UINT32
+                    _handleNumber(pSink, pData, pState, disasmOptions);  // CRC // Check UINT32
                 }
-                _handleTag(pListResults, pData, XSevenZip::k7zIdEnd, pState, disasmOptions);
+                _handleTag(pSink, pData, XSevenZip::k7zIdEnd, pState, disasmOptions);
             } else if (puTag.nValue == XSevenZip::k7zIdUnpackInfo) {
-                _handleTag(pListResults, pData, XSevenZip::k7zIdFolder, pState, disasmOptions);
-                _handleTag(pListResults, pData, XSevenZip::k7zIdEnd, pState, disasmOptions);
+                _handleTag(pSink, pData, XSevenZip::k7zIdFolder, pState, disasmOptions);
+                _handleTag(pSink, pData, XSevenZip::k7zIdEnd, pState, disasmOptions);
             } else if (puTag.nValue == XSevenZip::k7zIdSubStreamsInfo) {
                 // Default (no explicit kNumUnpackStream): one substream per folder.
                 quint64 nTotalSubStreams = (pState->nNumberOfFolders > 0) ? (quint64)pState->nNumberOfFolders : 0;
@@ -90,29 +90,29 @@ void X7Zip_Properties::_handleTag(QList<DISASM_RESULT> *pListResults, char *pDat
                     XBinary::PACKED_UINT puExtra = XBinary::_read_packedNumber(pData + pState->nCurrentOffset, pState->nMaxSize - pState->nCurrentOffset);
                     if (puExtra.bIsValid) {
                         if (puExtra.nValue == XSevenZip::k7zIdNumUnpackStream) {
-                            _addTagId(pListResults, puExtra.nValue, XSevenZip::k7zIdNumUnpackStream, pState, disasmOptions);
+                            _addTagId(pSink, puExtra.nValue, XSevenZip::k7zIdNumUnpackStream, pState, disasmOptions);
                             nTotalSubStreams = 0;
                             nFoldersWithStreams = 0;
                             for (qint64 i = 0; (i < pState->nNumberOfFolders) && (!(pState->bIsStop)); i++) {
-                                quint64 nNum = _handleNumber(pListResults, pData, pState, disasmOptions);  // NumUnpackStreamsInFolder
+                                quint64 nNum = _handleNumber(pSink, pData, pState, disasmOptions);  // NumUnpackStreamsInFolder
                                 nTotalSubStreams += nNum;
                                 if (nNum > 0) {
                                     nFoldersWithStreams++;
                                 }
                             }
                         } else if (puExtra.nValue == XSevenZip::k7zIdSize) {
-                            _addTagId(pListResults, puExtra.nValue, XSevenZip::k7zIdSize, pState, disasmOptions);
+                            _addTagId(pSink, puExtra.nValue, XSevenZip::k7zIdSize, pState, disasmOptions);
                             // A size is stored for every substream except the last of each non-empty folder (derived).
                             quint64 nSizeCount = (nTotalSubStreams > nFoldersWithStreams) ? (nTotalSubStreams - nFoldersWithStreams) : 0;
                             for (quint64 i = 0; (i < nSizeCount) && (!(pState->bIsStop)); i++) {
-                                _handleNumber(pListResults, pData, pState, disasmOptions);  // Size, NUMBER
+                                _handleNumber(pSink, pData, pState, disasmOptions);  // Size, NUMBER
                             }
                         } else if (puExtra.nValue == XSevenZip::k7zIdCRC) {
                             // TODO mb create a new if
-                            _addTagId(pListResults, puExtra.nValue, XSevenZip::k7zIdCRC, pState, disasmOptions);
-                            quint64 nCRCCount = _handleNumber(pListResults, pData, pState, disasmOptions);  // Count of CRC
+                            _addTagId(pSink, puExtra.nValue, XSevenZip::k7zIdCRC, pState, disasmOptions);
+                            quint64 nCRCCount = _handleNumber(pSink, pData, pState, disasmOptions);  // Count of CRC
                             for (quint64 i = 0; (i < nCRCCount) && (!(pState->bIsStop)); i++) {
-                                _handleUINT32(pListResults, pData, pState, disasmOptions);  // UnpackDigest, UINT32
+                                _handleUINT32(pSink, pData, pState, disasmOptions);  // UnpackDigest, UINT32
                             }
                         } else {
                             break;
@@ -121,82 +121,82 @@ void X7Zip_Properties::_handleTag(QList<DISASM_RESULT> *pListResults, char *pDat
                         pState->bIsStop = true;
                     }
                 }
-                _handleTag(pListResults, pData, XSevenZip::k7zIdEnd, pState, disasmOptions);
+                _handleTag(pSink, pData, XSevenZip::k7zIdEnd, pState, disasmOptions);
             } else if (puTag.nValue == XSevenZip::k7zIdFilesInfo) {
-                quint64 nNumberOfFiles = _handleNumber(pListResults, pData, pState, disasmOptions);  // Number of Files
+                quint64 nNumberOfFiles = _handleNumber(pSink, pData, pState, disasmOptions);  // Number of Files
                 for (quint64 i = 0; (i < nNumberOfFiles) && (!(pState->bIsStop)); i++) {
-                    _handleNumber(pListResults, pData, pState, disasmOptions);  // File ID, NUMBER
+                    _handleNumber(pSink, pData, pState, disasmOptions);  // File ID, NUMBER
                 }
             } else if (puTag.nValue == XSevenZip::k7zIdFolder) {
-                quint64 nNumberOfFolders = _handleNumber(pListResults, pData, pState, disasmOptions);  // Number of Folders
-                pState->nNumberOfFolders = (qint64)nNumberOfFolders;                                   // carried to SubStreamsInfo
-                quint8 nExt = _handleByte(pListResults, pData, pState, disasmOptions);                 // External
+                quint64 nNumberOfFolders = _handleNumber(pSink, pData, pState, disasmOptions);  // Number of Folders
+                pState->nNumberOfFolders = (qint64)nNumberOfFolders;                            // carried to SubStreamsInfo
+                quint8 nExt = _handleByte(pSink, pData, pState, disasmOptions);                 // External
 
                 quint64 nTotalOutStreamsAllFolders = 0;
 
                 if (nExt == 0) {
                     for (quint64 nFolder = 0; (nFolder < nNumberOfFolders) && (!(pState->bIsStop)); nFolder++) {
-                        quint64 nNumberOfCoders = _handleNumber(pListResults, pData, pState, disasmOptions);  // Number of Coders, NUMBER
+                        quint64 nNumberOfCoders = _handleNumber(pSink, pData, pState, disasmOptions);  // Number of Coders, NUMBER
 
                         quint64 nTotalInStreams = 0;
                         quint64 nTotalOutStreams = 0;
 
                         for (quint64 nCoder = 0; (nCoder < nNumberOfCoders) && (!(pState->bIsStop)); nCoder++) {
-                            quint8 nFlag = _handleByte(pListResults, pData, pState, disasmOptions);  // Flag
+                            quint8 nFlag = _handleByte(pSink, pData, pState, disasmOptions);  // Flag
                             qint32 nCodecSize = nFlag & 0x0F;
                             bool bIsComplex = (nFlag & 0x10) != 0;
                             bool bHasAttr = (nFlag & 0x20) != 0;
-                            _handleArray(pListResults, pData, nCodecSize, pState, disasmOptions);  // CodecId
+                            _handleArray(pSink, pData, nCodecSize, pState, disasmOptions);  // CodecId
 
                             if (bIsComplex) {
-                                nTotalInStreams += _handleNumber(pListResults, pData, pState, disasmOptions);   // NumInStreams
-                                nTotalOutStreams += _handleNumber(pListResults, pData, pState, disasmOptions);  // NumOutStreams
+                                nTotalInStreams += _handleNumber(pSink, pData, pState, disasmOptions);   // NumInStreams
+                                nTotalOutStreams += _handleNumber(pSink, pData, pState, disasmOptions);  // NumOutStreams
                             } else {
                                 nTotalInStreams += 1;
                                 nTotalOutStreams += 1;
                             }
 
                             if (bHasAttr) {
-                                quint64 nPropertySize = _handleNumber(pListResults, pData, pState, disasmOptions);  // PropertiesSize
-                                _handleArray(pListResults, pData, nPropertySize, pState, disasmOptions);            // Properties
+                                quint64 nPropertySize = _handleNumber(pSink, pData, pState, disasmOptions);  // PropertiesSize
+                                _handleArray(pSink, pData, nPropertySize, pState, disasmOptions);            // Properties
                             }
                         }
 
                         // BindPairs: (total out-streams - 1) pairs of (InIndex, OutIndex).
                         quint64 nNumBindPairs = (nTotalOutStreams > 0) ? (nTotalOutStreams - 1) : 0;
                         for (quint64 i = 0; (i < nNumBindPairs) && (!(pState->bIsStop)); i++) {
-                            _handleNumber(pListResults, pData, pState, disasmOptions);  // InIndex
-                            _handleNumber(pListResults, pData, pState, disasmOptions);  // OutIndex
+                            _handleNumber(pSink, pData, pState, disasmOptions);  // InIndex
+                            _handleNumber(pSink, pData, pState, disasmOptions);  // OutIndex
                         }
 
                         // PackedStreams: an explicit index list is present only when more than one remains.
                         quint64 nNumPackedStreams = (nTotalInStreams >= nNumBindPairs) ? (nTotalInStreams - nNumBindPairs) : 0;
                         if (nNumPackedStreams > 1) {
                             for (quint64 i = 0; (i < nNumPackedStreams) && (!(pState->bIsStop)); i++) {
-                                _handleNumber(pListResults, pData, pState, disasmOptions);  // Index
+                                _handleNumber(pSink, pData, pState, disasmOptions);  // Index
                             }
                         }
 
                         nTotalOutStreamsAllFolders += nTotalOutStreams;
                     }
                 } else if (nExt == 1) {
-                    _handleNumber(pListResults, pData, pState, disasmOptions);  // Data Stream Index, NUMBER
+                    _handleNumber(pSink, pData, pState, disasmOptions);  // Data Stream Index, NUMBER
                 }
 
                 while (!(pState->bIsStop)) {
                     XBinary::PACKED_UINT puExtra = XBinary::_read_packedNumber(pData + pState->nCurrentOffset, pState->nMaxSize - pState->nCurrentOffset);
                     if (puExtra.bIsValid) {
                         if (puExtra.nValue == XSevenZip::k7zIdCodersUnpackSize) {
-                            _addTagId(pListResults, puExtra.nValue, XSevenZip::k7zIdCodersUnpackSize, pState, disasmOptions);
+                            _addTagId(pSink, puExtra.nValue, XSevenZip::k7zIdCodersUnpackSize, pState, disasmOptions);
                             // One unpack size per output stream, summed over every folder.
                             for (quint64 i = 0; (i < nTotalOutStreamsAllFolders) && (!(pState->bIsStop)); i++) {
-                                _handleNumber(pListResults, pData, pState, disasmOptions);  // Unpacksize, NUMBER
+                                _handleNumber(pSink, pData, pState, disasmOptions);  // Unpacksize, NUMBER
                             }
                         } else if (puExtra.nValue == XSevenZip::k7zIdCRC) {
-                            _addTagId(pListResults, puExtra.nValue, XSevenZip::k7zIdCRC, pState, disasmOptions);
-                            quint64 nCRCCount = _handleNumber(pListResults, pData, pState, disasmOptions);  // Count of CRC
+                            _addTagId(pSink, puExtra.nValue, XSevenZip::k7zIdCRC, pState, disasmOptions);
+                            quint64 nCRCCount = _handleNumber(pSink, pData, pState, disasmOptions);  // Count of CRC
                             for (quint64 i = 0; (i < nCRCCount) && (!(pState->bIsStop)); i++) {
-                                _handleUINT32(pListResults, pData, pState, disasmOptions);  // UnpackDigest, UINT32
+                                _handleUINT32(pSink, pData, pState, disasmOptions);  // UnpackDigest, UINT32
                             }
                         } else {
                             break;
@@ -214,7 +214,7 @@ void X7Zip_Properties::_handleTag(QList<DISASM_RESULT> *pListResults, char *pDat
     }
 }
 
-quint64 X7Zip_Properties::_handleNumber(QList<DISASM_RESULT> *pListResults, char *pData, STATE *pState, const DISASM_OPTIONS &disasmOptions)
+quint64 X7Zip_Properties::_handleNumber(XDisasmSink *pSink, char *pData, STATE *pState, const DISASM_OPTIONS &disasmOptions)
 {
     if (pState->bIsStop) {
         return 0;
@@ -226,7 +226,7 @@ quint64 X7Zip_Properties::_handleNumber(QList<DISASM_RESULT> *pListResults, char
 
     if (puTag.bIsValid) {
         nResult = puTag.nValue;
-        _addDisasmResult(pListResults, pState->nAddress + pState->nCurrentOffset, puTag.nByteSize, "NUMBER", QString("0x%1").arg(QString::number(puTag.nValue, 16)),
+        _addDisasmResult(pSink, pState->nAddress + pState->nCurrentOffset, puTag.nByteSize, "NUMBER", QString("0x%1").arg(QString::number(puTag.nValue, 16)),
                          pState, disasmOptions);
     } else {
         pState->bIsStop = true;
@@ -235,7 +235,7 @@ quint64 X7Zip_Properties::_handleNumber(QList<DISASM_RESULT> *pListResults, char
     return nResult;
 }
 
-quint8 X7Zip_Properties::_handleByte(QList<DISASM_RESULT> *pListResults, char *pData, STATE *pState, const DISASM_OPTIONS &disasmOptions)
+quint8 X7Zip_Properties::_handleByte(XDisasmSink *pSink, char *pData, STATE *pState, const DISASM_OPTIONS &disasmOptions)
 {
     if (pState->bIsStop) {
         return 0;
@@ -246,7 +246,7 @@ quint8 X7Zip_Properties::_handleByte(QList<DISASM_RESULT> *pListResults, char *p
     if (pState->nCurrentOffset + 1 <= pState->nMaxSize) {
         nResult = XBinary::_read_uint8(pData + pState->nCurrentOffset);
 
-        _addDisasmResult(pListResults, pState->nAddress + pState->nCurrentOffset, 1, "BYTE", QString("0x%1").arg(QString::number(nResult, 16)), pState, disasmOptions);
+        _addDisasmResult(pSink, pState->nAddress + pState->nCurrentOffset, 1, "BYTE", QString("0x%1").arg(QString::number(nResult, 16)), pState, disasmOptions);
     } else {
         pState->bIsStop = true;
     }
@@ -254,7 +254,7 @@ quint8 X7Zip_Properties::_handleByte(QList<DISASM_RESULT> *pListResults, char *p
     return nResult;
 }
 
-quint32 X7Zip_Properties::_handleUINT32(QList<DISASM_RESULT> *pListResults, char *pData, STATE *pState, const DISASM_OPTIONS &disasmOptions)
+quint32 X7Zip_Properties::_handleUINT32(XDisasmSink *pSink, char *pData, STATE *pState, const DISASM_OPTIONS &disasmOptions)
 {
     if (pState->bIsStop) {
         return 0;
@@ -265,7 +265,8 @@ quint32 X7Zip_Properties::_handleUINT32(QList<DISASM_RESULT> *pListResults, char
     if (pState->nCurrentOffset + 4 <= pState->nMaxSize) {
         nResult = XBinary::_read_uint32(pData + pState->nCurrentOffset);
 
-        _addDisasmResult(pListResults, pState->nAddress + pState->nCurrentOffset, 4, "UINT32", QString("0x%1").arg(QString::number(nResult, 16)), pState, disasmOptions);
+        _addDisasmResult(pSink, pState->nAddress + pState->nCurrentOffset, 4, "UINT32", QString("0x%1").arg(QString::number(nResult, 16)), pState,
+                         disasmOptions);
     } else {
         pState->bIsStop = true;
     }
@@ -273,7 +274,7 @@ quint32 X7Zip_Properties::_handleUINT32(QList<DISASM_RESULT> *pListResults, char
     return nResult;
 }
 
-void X7Zip_Properties::_handleArray(QList<DISASM_RESULT> *pListResults, char *pData, quint64 nDataSize, STATE *pState, const DISASM_OPTIONS &disasmOptions)
+void X7Zip_Properties::_handleArray(XDisasmSink *pSink, char *pData, quint64 nDataSize, STATE *pState, const DISASM_OPTIONS &disasmOptions)
 {
     if (pState->bIsStop) {
         return;
@@ -285,21 +286,18 @@ void X7Zip_Properties::_handleArray(QList<DISASM_RESULT> *pListResults, char *pD
         const qint32 nArraySize = (qint32)nDataSize;
         QByteArray baResult = XBinary::_read_byteArray(pData + pState->nCurrentOffset, nArraySize);
 
-        _addDisasmResult(pListResults, pState->nAddress + pState->nCurrentOffset, nArraySize, "ARRAY", baResult.toHex(), pState, disasmOptions);
+        _addDisasmResult(pSink, pState->nAddress + pState->nCurrentOffset, nArraySize, "ARRAY", baResult.toHex(), pState, disasmOptions);
     } else {
         pState->bIsStop = true;
     }
 }
 
-QList<XDisasmAbstract::DISASM_RESULT> X7Zip_Properties::_disasm(char *pData, qint32 nDataSize, XADDR nAddress, const DISASM_OPTIONS &disasmOptions, qint32 nLimit,
-                                                                XBinary::PDSTRUCT *pPdStruct)
+void X7Zip_Properties::_disasm(char *pData, qint32 nDataSize, XADDR nAddress, const DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink,
+                               XBinary::PDSTRUCT *pPdStruct)
 {
     Q_UNUSED(pPdStruct)
 
-    QList<XDisasmAbstract::DISASM_RESULT> listResult;
-
     STATE state = {};
-    state.nLimit = nLimit;
     state.nMaxSize = nDataSize;
     state.nAddress = nAddress;
 
@@ -307,11 +305,9 @@ QList<XDisasmAbstract::DISASM_RESULT> X7Zip_Properties::_disasm(char *pData, qin
 
     if (puTag.bIsValid) {
         if (puTag.nValue == XSevenZip::k7zIdHeader) {
-            _handleTag(&listResult, pData, XSevenZip::k7zIdHeader, &state, disasmOptions);
+            _handleTag(pSink, pData, XSevenZip::k7zIdHeader, &state, disasmOptions);
         } else if (puTag.nValue == XSevenZip::k7zIdEncodedHeader) {
-            _handleTag(&listResult, pData, XSevenZip::k7zIdEncodedHeader, &state, disasmOptions);
+            _handleTag(pSink, pData, XSevenZip::k7zIdEncodedHeader, &state, disasmOptions);
         }
     }
-
-    return listResult;
 }
@@ -30,16 +30,16 @@ class X7Zip_Properties : public XDisasmAbstract {
 public:
     explicit X7Zip_Properties(QObject *pParent = nullptr);
 
-    virtual QList<DISASM_RESULT> _disasm(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, qint32 nLimit,
-                                         XBinary::PDSTRUCT *pPdStruct);
+    virtual void _disasm(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink,
+                         XBinary::PDSTRUCT *pPdStruct);
 
 private:
-    void _addTagId(QList<DISASM_RESULT> *pListResults, quint64 nValue, XSevenZip::EIdEnum id, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
-    void _handleTag(QList<DISASM_RESULT> *pListResults, char *pData, XSevenZip::EIdEnum id, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
-    quint64 _handleNumber(QList<DISASM_RESULT> *pListResults, char *pData, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
-    quint8 _handleByte(QList<DISASM_RESULT> *pListResults, char *pData, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
-    quint32 _handleUINT32(QList<DISASM_RESULT> *pListResults, char *pData, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
-    void _handleArray(QList<DISASM_RESULT> *pListResults, char *pData, quint64 nDataSize, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
+    void _addTagId(XDisasmSink *pSink, quint64 nValue, XSevenZip::EIdEnum id, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
+    void _handleTag(XDisasmSink *pSink, char *pData, XSevenZip::EIdEnum id, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
+    quint64 _handleNumber(XDisasmSink *pSink, char *pData, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
+    quint8 _handleByte(XDisasmSink *pSink, char *pData, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
+    quint32 _handleUINT32(XDisasmSink *pSink, char *pData, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
+    void _handleArray(XDisasmSink *pSink, char *pData, quint64 nDataSize, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
 };
 
 #endif  // X7ZIP_PROPERTIES_H
@@ -47,7 +47,7 @@ XMachO_Commands::XMachO_Commands(XBinary::DM disasmMode, QObject *pParent) : XDi
     m_disasmMode = disasmMode;
 }
 
-quint64 XMachO_Commands::_handleULEB128(QList<DISASM_RESULT> *pListResults, char *pData, STATE *pState, const DISASM_OPTIONS &disasmOptions, const QString &sPrefix)
+quint64 XMachO_Commands::_handleULEB128(XDisasmSink *pSink, char *pData, STATE *pState, const DISASM_OPTIONS &disasmOptions, const QString &sPrefix)
 {
     if (pState->bIsStop) {
         return 0;
@@ -59,7 +59,7 @@ quint64 XMachO_Commands::_handleULEB128(QList<DISASM_RESULT> *pListResults, char
 
     if (puTag.bIsValid) {
         nResult = puTag.nValue;
-        _addDisasmResult(pListResults, pState->nAddress + pState->nCurrentOffset, puTag.nByteSize, sPrefix, QString("0x%1").arg(QString::number(puTag.nValue, 16)),
+        _addDisasmResult(pSink, pState->nAddress + pState->nCurrentOffset, puTag.nByteSize, sPrefix, QString("0x%1").arg(QString::number(puTag.nValue, 16)),
                          pState, disasmOptions);
     } else {
         pState->bIsStop = true;
@@ -68,7 +68,7 @@ quint64 XMachO_Commands::_handleULEB128(QList<DISASM_RESULT> *pListResults, char
     return nResult;
 }
 
-QString XMachO_Commands::_handleAnsiString(QList<DISASM_RESULT> *pListResults, char *pData, STATE *pState, const DISASM_OPTIONS &disasmOptions, const QString &sPrefix)
+QString XMachO_Commands::_handleAnsiString(XDisasmSink *pSink, char *pData, STATE *pState, const DISASM_OPTIONS &disasmOptions, const QString &sPrefix)
 {
     if (pState->bIsStop) {
         return {};
@@ -78,7 +78,7 @@ QString XMachO_Commands::_handleAnsiString(QList<DISASM_RESULT> *pListResults, c
     QString sResult = XBinary::_read_ansiString(pData + pState->nCurrentOffset, nMaxSize);
 
     if (!sResult.isEmpty()) {
-        _addDisasmResult(pListResults, pState->nAddress + pState->nCurrentOffset, sResult.size() + 1, sPrefix, sResult, pState, disasmOptions);
+        _addDisasmResult(pSink, pState->nAddress + pState->nCurrentOffset, sResult.size() + 1, sPrefix, sResult, pState, disasmOptions);
     } else {
         pState->bIsStop = true;
     }
@@ -86,19 +86,16 @@ QString XMachO_Commands::_handleAnsiString(QList<DISASM_RESULT> *pListResults, c
     return sResult;
 }
 
-QList<XDisasmAbstract::DISASM_RESULT> XMachO_Commands::_disasm(char *pData, qint32 nDataSize, XADDR nAddress, const DISASM_OPTIONS &disasmOptions, qint32 nLimit,
-                                                               XBinary::PDSTRUCT *pPdStruct)
+void XMachO_Commands::_disasm(char *pData, qint32 nDataSize, XADDR nAddress, const DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink,
+                              XBinary::PDSTRUCT *pPdStruct)
 {
-    QList<XDisasmAbstract::DISASM_RESULT> listResult;
-
     STATE state = {};
-    state.nLimit = nLimit;
     state.nMaxSize = nDataSize;
     state.nAddress = nAddress;
 
     if (m_disasmMode == XBinary::DM_CUSTOM_MACH_EXPORT) {
         while (!(state.bIsStop) && XBinary::isPdStructNotCanceled(pPdStruct)) {
-            quint64 nTerminalSize = _handleULEB128(&listResult, pData, &state, disasmOptions, "TERMINAL_SIZE");
+            quint64 nTerminalSize = _handleULEB128(pSink, pData, &state, disasmOptions, "TERMINAL_SIZE");
 
             // The terminal payload occupies exactly nTerminalSize bytes. Regular exports store FLAGS +
             // SYMBOL_OFFSET, but re-export and stub-and-resolver kinds carry extra bytes. Bound the payload
@@ -106,8 +103,8 @@ QList<XDisasmAbstract::DISASM_RESULT> XMachO_Commands::_disasm(char *pData, qint
             const qint64 nTermPayloadStart = state.nCurrentOffset;
 
             if (nTerminalSize > 0) {
-                _handleULEB128(&listResult, pData, &state, disasmOptions, "FLAGS");
-                _handleULEB128(&listResult, pData, &state, disasmOptions, "SYMBOL_OFFSET");
+                _handleULEB128(pSink, pData, &state, disasmOptions, "FLAGS");
+                _handleULEB128(pSink, pData, &state, disasmOptions, "SYMBOL_OFFSET");
 
                 if (!state.bIsStop) {
                     const qint64 nTermPayloadEnd = nTermPayloadStart + (qint64)nTerminalSize;
@@ -123,12 +120,12 @@ QList<XDisasmAbstract::DISASM_RESULT> XMachO_Commands::_disasm(char *pData, qint
             quint64 nChildCount = 0;
 
             if (!state.bIsStop) {
-                nChildCount = _handleULEB128(&listResult, pData, &state, disasmOptions, "CHILD_COUNT");
+                nChildCount = _handleULEB128(pSink, pData, &state, disasmOptions, "CHILD_COUNT");
             }
 
             for (quint64 i = 0; (i < nChildCount) && (!state.bIsStop); i++) {
-                _handleAnsiString(&listResult, pData, &state, disasmOptions, "NODE_LABEL");
-                _handleULEB128(&listResult, pData, &state, disasmOptions, "NODE_OFFSET");
+                _handleAnsiString(pSink, pData, &state, disasmOptions, "NODE_LABEL");
+                _handleULEB128(pSink, pData, &state, disasmOptions, "NODE_OFFSET");
             }
 
             if ((nTerminalSize == 0) && (nChildCount == 0)) {
@@ -341,7 +338,7 @@ QList<XDisasmAbstract::DISASM_RESULT> XMachO_Commands::_disasm(char *pData, qint
             }
 
             if (!state.bIsStop) {
-                _addDisasmResult(&listResult, state.nAddress + state.nCurrentOffset, nOpcodeSize, sMnemonic, sString, &state, disasmOptions);
+                _addDisasmResult(pSink, state.nAddress + state.nCurrentOffset, nOpcodeSize, sMnemonic, sString, &state, disasmOptions);
             }
 
             // 0x00 is REBASE_OPCODE_DONE / BIND_OPCODE_DONE and terminates the stream. Stop after emitting the
@@ -351,8 +348,6 @@ QList<XDisasmAbstract::DISASM_RESULT> XMachO_Commands::_disasm(char *pData, qint
             }
         }
     }
-    // Any other mode is not handled by this backend; return an empty list rather than a fabricated
+    // Any other mode is not handled by this backend; emit nothing rather than a fabricated
     // "ARRAY TST" record. (XDisasmCore::setMode only routes the four custom Mach-O modes here.)
-
-    return listResult;
 }
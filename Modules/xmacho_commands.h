@@ -31,12 +31,12 @@ class XMachO_Commands : public XDisasmAbstract {
 public:
     explicit XMachO_Commands(XBinary::DM disasmMode, QObject *pParent = nullptr);
 
-    virtual QList<DISASM_RESULT> _disasm(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, qint32 nLimit,
-                                         XBinary::PDSTRUCT *pPdStruct);
+    virtual void _disasm(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink,
+                         XBinary::PDSTRUCT *pPdStruct);
 
 private:
-    quint64 _handleULEB128(QList<DISASM_RESULT> *pListResults, char *pData, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, const QString &sPrefix);
-    QString _handleAnsiString(QList<DISASM_RESULT> *pListResults, char *pData, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions,
+    quint64 _handleULEB128(XDisasmSink *pSink, char *pData, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, const QString &sPrefix);
+    QString _handleAnsiString(XDisasmSink *pSink, char *pData, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions,
                               const QString &sPrefix);
 
 private:
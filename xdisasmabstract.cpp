@@ -21,6 +21,239 @@
 
 #include "xdisasmabstract.h"
 
+Q_STATIC_ASSERT(sizeof(XDisasmAbstract::DISASM_RECORD) <= 32);
+Q_STATIC_ASSERT(std::is_trivially_copyable<XDisasmAbstract::DISASM_RECORD>::value);
+
+// Source of the opcode class tables: one entry per (opcode, class); an opcode may appear more than once
+struct OPCODECLASS_RECORD {
+    quint32 nOpcodeID;
+    quint16 nClass;
+};
+
+static const OPCODECLASS_RECORD g_opcodeClassesX86[] = {
+    {X86_INS_JMP, XDisasmAbstract::OPCODECLASS_JMP},
+    {X86_INS_RET, XDisasmAbstract::OPCODECLASS_RET},
+    {X86_INS_RETF, XDisasmAbstract::OPCODECLASS_RET},
+    {X86_INS_RETFQ, XDisasmAbstract::OPCODECLASS_RET},
+    {X86_INS_IRET, XDisasmAbstract::OPCODECLASS_RET},
+    {X86_INS_IRETD, XDisasmAbstract::OPCODECLASS_RET},
+    {X86_INS_IRETQ, XDisasmAbstract::OPCODECLASS_RET},
+    {X86_INS_PUSH, XDisasmAbstract::OPCODECLASS_PUSH},
+    {X86_INS_PUSHF, XDisasmAbstract::OPCODECLASS_PUSH},
+    {X86_INS_PUSHFD, XDisasmAbstract::OPCODECLASS_PUSH},
+    {X86_INS_PUSHFQ, XDisasmAbstract::OPCODECLASS_PUSH},
+    {X86_INS_POP, XDisasmAbstract::OPCODECLASS_POP},
+    {X86_INS_POPF, XDisasmAbstract::OPCODECLASS_POP},
+    {X86_INS_POPFD, XDisasmAbstract::OPCODECLASS_POP},
+    {X86_INS_POPFQ, XDisasmAbstract::OPCODECLASS_POP},
+    {X86_INS_CALL, XDisasmAbstract::OPCODECLASS_CALL},
+    {X86_INS_JA, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JAE, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JB, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JBE, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JCXZ, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JE, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JECXZ, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JG, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JGE, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JL, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JLE, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JNE, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JNO, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JNP, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JNS, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JO, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JP, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JRCXZ, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_JS, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_LOOP, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_LOOPE, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_LOOPNE, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {X86_INS_NOP, XDisasmAbstract::OPCODECLASS_NOP},
+    {X86_INS_INT3, XDisasmAbstract::OPCODECLASS_INT3},
+    {X86_INS_SYSCALL, XDisasmAbstract::OPCODECLASS_SYSCALL},
+};
+
+static const OPCODECLASS_RECORD g_opcodeClassesARM[] = {
+    {ARM_INS_B, XDisasmAbstract::OPCODECLASS_JMP},
+    {ARM_INS_BX, XDisasmAbstract::OPCODECLASS_JMP},
+    {ARM_INS_PUSH, XDisasmAbstract::OPCODECLASS_PUSH},  // Thumb; classic ARM uses STMDB SP! which Capstone decodes differently
+    {ARM_INS_POP, XDisasmAbstract::OPCODECLASS_POP},
+    {ARM_INS_BL, XDisasmAbstract::OPCODECLASS_CALL},
+    {ARM_INS_BLX, XDisasmAbstract::OPCODECLASS_CALL},
+    {ARM_INS_NOP, XDisasmAbstract::OPCODECLASS_NOP},
+    // TODO ARM/ARM64 condition codes live in cs_detail (arm.cc/arm64.cc), not the opcode id; and emitting
+    // RELTYPE_JMP_COND + nXrefToRelative for these families also needs per-arch operand extraction in Capstone_Bridge.
+};
+
+static const OPCODECLASS_RECORD g_opcodeClassesARM64[] = {
+    {ARM64_INS_B, XDisasmAbstract::OPCODECLASS_JMP},
+    {ARM64_INS_BR, XDisasmAbstract::OPCODECLASS_JMP},
+    {ARM64_INS_RET, XDisasmAbstract::OPCODECLASS_RET},
+    {ARM64_INS_RETAA, XDisasmAbstract::OPCODECLASS_RET},
+    {ARM64_INS_RETAB, XDisasmAbstract::OPCODECLASS_RET},
+    {ARM64_INS_BL, XDisasmAbstract::OPCODECLASS_CALL},
+    {ARM64_INS_BLR, XDisasmAbstract::OPCODECLASS_CALL},
+    {ARM64_INS_NOP, XDisasmAbstract::OPCODECLASS_NOP},
+};
+
+static const OPCODECLASS_RECORD g_opcodeClassesBPF[] = {
+    {BPF_INS_JMP, XDisasmAbstract::OPCODECLASS_JMP},
+    {BPF_INS_RET, XDisasmAbstract::OPCODECLASS_RET},
+    {BPF_INS_EXIT, XDisasmAbstract::OPCODECLASS_RET},
+    {BPF_INS_CALL, XDisasmAbstract::OPCODECLASS_CALL},
+    {BPF_INS_JEQ, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {BPF_INS_JNE, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {BPF_INS_JGT, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {BPF_INS_JGE, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {BPF_INS_JLT, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {BPF_INS_JLE, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {BPF_INS_JSET, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {BPF_INS_JSGT, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {BPF_INS_JSGE, XDisasmAbstract::OPCODECLASS_CONDJMP},
+};
+
+static const OPCODECLASS_RECORD g_opcodeClassesSPARC[] = {
+    {SPARC_INS_JMP, XDisasmAbstract::OPCODECLASS_JMP},
+    {SPARC_INS_RET, XDisasmAbstract::OPCODECLASS_RET},
+    {SPARC_INS_RETL, XDisasmAbstract::OPCODECLASS_RET},
+    {SPARC_INS_CALL, XDisasmAbstract::OPCODECLASS_CALL},
+    {SPARC_INS_JMPL, XDisasmAbstract::OPCODECLASS_CALL},
+    {SPARC_INS_NOP, XDisasmAbstract::OPCODECLASS_NOP},
+};
+
+static const OPCODECLASS_RECORD g_opcodeClassesMIPS[] = {
+    {MIPS_INS_J, XDisasmAbstract::OPCODECLASS_JMP},
+    {MIPS_INS_JR, XDisasmAbstract::OPCODECLASS_RET},  // JR ra
+    {MIPS_INS_ERET, XDisasmAbstract::OPCODECLASS_RET},
+    {MIPS_INS_JAL, XDisasmAbstract::OPCODECLASS_CALL},
+    {MIPS_INS_JALR, XDisasmAbstract::OPCODECLASS_CALL},
+    {MIPS_INS_BEQ, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {MIPS_INS_BNE, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {MIPS_INS_BGEZ, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {MIPS_INS_BGTZ, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {MIPS_INS_BLEZ, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {MIPS_INS_BLTZ, XDisasmAbstract::OPCODECLASS_CONDJMP},
+    {MIPS_INS_NOP, XDisasmAbstract::OPCODECLASS_NOP},
+};
+
+static const OPCODECLASS_RECORD g_opcodeClassesMOS65XX[] = {
+    {MOS65XX_INS_JMP, XDisasmAbstract::OPCODECLASS_JMP},
+    {MOS65XX_INS_RTS, XDisasmAbstract::OPCODECLASS_RET},
+    {MOS65XX_INS_RTI, XDisasmAbstract::OPCODECLASS_RET},
+    {MOS65XX_INS_PHA, XDisasmAbstract::OPCODECLASS_PUSH},
+    {MOS65XX_INS_PHP, XDisasmAbstract::OPCODECLASS_PUSH},
+    {MOS65XX_INS_PLA, XDisasmAbstract::OPCODECLASS_POP},
+    {MOS65XX_INS_PLX, XDisasmAbstract::OPCODECLASS_POP},
+    {MOS65XX_INS_PLY, XDisasmAbstract::OPCODECLASS_POP},
+    {MOS65XX_INS_PLP, XDisasmAbstract::OPCODECLASS_POP},
+    {MOS65XX_INS_JSR, XDisasmAbstract::OPCODECLASS_CALL},
+    {MOS65XX_INS_NOP, XDisasmAbstract::OPCODECLASS_NOP},
+};
+
+static const OPCODECLASS_RECORD g_opcodeClassesM68K[] = {
+    {M68K_INS_BRA, XDisasmAbstract::OPCODECLASS_JMP},
+    {M68K_INS_JMP, XDisasmAbstract::OPCODECLASS_JMP},
+    {M68K_INS_RTS, XDisasmAbstract::OPCODECLASS_RET},
+    {M68K_INS_RTE, XDisasmAbstract::OPCODECLASS_RET},
+    {M68K_INS_RTR, XDisasmAbstract::OPCODECLASS_RET},
+    {M68K_INS_RTD, XDisasmAbstract::OPCODECLASS_RET},
+    {M68K_INS_PEA, XDisasmAbstract::OPCODECLASS_PUSH},  // Pushes the effective address onto the stack
+    {M68K_INS_BSR, XDisasmAbstract::OPCODECLASS_CALL},
+    {M68K_INS_JSR, XDisasmAbstract::OPCODECLASS_CALL},
+    {M68K_INS_NOP, XDisasmAbstract::OPCODECLASS_NOP},
+};
+
+static const OPCODECLASS_RECORD g_opcodeClassesPPC[] = {
+    {PPC_INS_B, XDisasmAbstract::OPCODECLASS_JMP},
+    {PPC_INS_BA, XDisasmAbstract::OPCODECLASS_JMP},
+    {PPC_INS_BLR, XDisasmAbstract::OPCODECLASS_RET},  // Branch to link register
+    {PPC_INS_BL, XDisasmAbstract::OPCODECLASS_CALL},
+    {PPC_INS_BLA, XDisasmAbstract::OPCODECLASS_CALL},
+    {PPC_INS_BC, XDisasmAbstract::OPCODECLASS_CONDJMP},
+};
+
+static const OPCODECLASS_RECORD g_opcodeClassesWASM[] = {
+    {WASM_INS_BR, XDisasmAbstract::OPCODECLASS_JMP},
+    {WASM_INS_CALL, XDisasmAbstract::OPCODECLASS_CALL},
+    {WASM_INS_NOP, XDisasmAbstract::OPCODECLASS_NOP},
+};
+
+static QVector<quint16> _buildOpcodeClassTable(quint32 nNumberOfOpcodes, const OPCODECLASS_RECORD *pRecords, qint32 nNumberOfRecords)
+{
+    QVector<quint16> listResult(nNumberOfOpcodes, 0);
+
+    for (qint32 i = 0; i < nNumberOfRecords; i++) {
+        if (pRecords[i].nOpcodeID < nNumberOfOpcodes) {
+            listResult[pRecords[i].nOpcodeID] |= pRecords[i].nClass;
+        }
+    }
+
+    return listResult;
+}
+
+// Register names are short lowercase ASCII: packed into a quint64 they are hashed without a QString
+static quint64 _packRegisterName(const QChar *pName, qint32 nSize)
+{
+    quint64 nResult = 0;
+
+    if ((nSize > 0) && (nSize <= 8)) {
+        for (qint32 i = 0; i < nSize; i++) {
+            ushort nChar = pName[i].unicode();
+
+            if ((nChar == 0) || (nChar >= 0x80)) {
+                nResult = 0;
+                break;
+            }
+
+            nResult |= ((quint64)nChar) << (8 * i);
+        }
+    }
+
+    return nResult;
+}
+
+static QHash<quint64, quint16> _buildRegisterClassesX86()
+{
+    QHash<quint64, quint16> mapResult;
+
+    const char *pszGeneral[] = {"al",   "ah",   "bl",   "bh",   "cl",   "ch",   "dl",   "dh",   "ax",   "bx",   "cx",   "dx",   "si",   "di",
+                                "sp",   "bp",   "eax",  "ebx",  "ecx",  "edx",  "esi",  "edi",  "esp",  "ebp",  "rax",  "rbx",  "rcx",  "rdx",
+                                "rsi",  "rdi",  "rsp",  "rbp",  "r8",   "r9",   "r10",  "r11",  "r12",  "r13",  "r14",  "r15",  "r8b",  "r9b",
+                                "r10b", "r11b", "r12b", "r13b", "r14b", "r15b", "r8d",  "r9d",  "r10d", "r11d", "r12d", "r13d", "r14d", "r15d"};
+    const char *pszStack[] = {"sp", "bp", "esp", "ebp", "rsp", "rbp"};
+    const char *pszSegment[] = {"es", "gs", "ss", "ds", "cs", "fs"};
+    const char *pszDebug[] = {"dr0", "dr1", "dr2", "dr3", "dr6", "dr7"};
+    const char *pszIP[] = {"ip", "eip", "rip"};
+    const char *pszFlags[] = {"flags", "eflags", "rflags"};
+    const char *pszFPU[] = {"st", "st0", "st1", "st2", "st3", "st4", "st5", "st6", "st7"};
+
+    struct GROUP {
+        const char **ppszNames;
+        qint32 nNumberOfNames;
+        quint16 nClass;
+    };
+
+    const GROUP groups[] = {{pszGeneral, sizeof(pszGeneral) / sizeof(char *), XDisasmAbstract::OPERANDCLASS_GENERAL},
+                            {pszStack, sizeof(pszStack) / sizeof(char *), XDisasmAbstract::OPERANDCLASS_STACK},
+                            {pszSegment, sizeof(pszSegment) / sizeof(char *), XDisasmAbstract::OPERANDCLASS_SEGMENT},
+                            {pszDebug, sizeof(pszDebug) / sizeof(char *), XDisasmAbstract::OPERANDCLASS_DEBUG},
+                            {pszIP, sizeof(pszIP) / sizeof(char *), XDisasmAbstract::OPERANDCLASS_IP},
+                            {pszFlags, sizeof(pszFlags) / sizeof(char *), XDisasmAbstract::OPERANDCLASS_FLAGS},
+                            {pszFPU, sizeof(pszFPU) / sizeof(char *), XDisasmAbstract::OPERANDCLASS_FPU}};
+
+    for (const GROUP &group : groups) {
+        for (qint32 i = 0; i < group.nNumberOfNames; i++) {
+            QString sName = QString::fromLatin1(group.ppszNames[i]);
+            quint64 nKey = _packRegisterName(sName.constData(), sName.size());
+
+            mapResult.insert(nKey, mapResult.value(nKey, 0) | group.nClass);
+        }
+    }
+
+    return mapResult;
+}
+
 XDisasmAbstract::XDisasmAbstract(QObject *pParent) : QObject(pParent)
 {
 }
@@ -62,34 +295,129 @@ QString XDisasmAbstract::getOpcodeFullString(const DISASM_RESULT &disasmResult)
     return sResult;
 }
 
-void XDisasmAbstract::_addDisasmResult(QList<DISASM_RESULT> *pListResults, DISASM_RESULT &disasmResult, STATE *pState,
-                                       const XDisasmAbstract::DISASM_OPTIONS &disasmOptions)
+XDisasmAbstract::DISASM_RECORD XDisasmAbstract::toRecord(const DISASM_RESULT &disasmResult)
 {
-    if (pState->nLimit == 0) {
-        if (!disasmResult.bIsValid) {
-            pState->bIsStop = true;
-        }
+    DISASM_RECORD result = {};
+
+    result.nAddress = disasmResult.nAddress;
+    result.nSize = disasmResult.nSize;
+    result.nOpcode = (quint16)disasmResult.nOpcode;
+    result.nRelType = (quint8)disasmResult.relType;
+    result.nMemType = (quint8)disasmResult.memType;
+    result.nMemorySize = (quint8)disasmResult.nMemorySize;
+    result.nDispOffset = (quint8)disasmResult.nDispOffset;
+    result.nDispSize = (quint8)disasmResult.nDispSize;
+    result.nImmOffset = (quint8)disasmResult.nImmOffset;
+    result.nImmSize = (quint8)disasmResult.nImmSize;
+
+    // A relative branch never carries a memory operand in the supported families, so one slot holds either xref.
+    if (disasmResult.relType != RELTYPE_NONE) {
+        result.nXrefTo = disasmResult.nXrefToRelative;
+    } else {
+        result.nXrefTo = disasmResult.nXrefToMemory;
+    }
+
+    if (disasmResult.bIsValid) {
+        result.nFlags |= RECFLAG_VALID;
+    }
+
+    if (disasmResult.bMemError) {
+        result.nFlags |= RECFLAG_MEMERROR;
+    }
+
+    if (disasmResult.bIsConst) {
+        result.nFlags |= RECFLAG_CONST;
+    }
+
+    if (disasmResult.bIsRet) {
+        result.nFlags |= RECFLAG_RET;
+    }
+
+    if (disasmResult.bIsCall) {
+        result.nFlags |= RECFLAG_CALL;
+    }
+
+    if (disasmResult.bIsJmp) {
+        result.nFlags |= RECFLAG_JMP;
     }
 
+    if (disasmResult.bIsCondJmp) {
+        result.nFlags |= RECFLAG_CONDJMP;
+    }
+
+    return result;
+}
+
+XDisasmAbstract::DISASM_RESULT XDisasmAbstract::fromRecord(const DISASM_RECORD &record)
+{
+    DISASM_RESULT result = {};
+
+    result.bIsValid = ((record.nFlags & RECFLAG_VALID) != 0);
+    result.bMemError = ((record.nFlags & RECFLAG_MEMERROR) != 0);
+    result.bIsConst = ((record.nFlags & RECFLAG_CONST) != 0);
+    result.bIsRet = ((record.nFlags & RECFLAG_RET) != 0);
+    result.bIsCall = ((record.nFlags & RECFLAG_CALL) != 0);
+    result.bIsJmp = ((record.nFlags & RECFLAG_JMP) != 0);
+    result.bIsCondJmp = ((record.nFlags & RECFLAG_CONDJMP) != 0);
+    result.nAddress = record.nAddress;
+    result.nSize = record.nSize;
+    result.nOpcode = record.nOpcode;
+    result.relType = (RELTYPE)record.nRelType;
+    result.memType = (MEMTYPE)record.nMemType;
+    result.nMemorySize = record.nMemorySize;
+    result.nDispOffset = record.nDispOffset;
+    result.nDispSize = record.nDispSize;
+    result.nImmOffset = record.nImmOffset;
+    result.nImmSize = record.nImmSize;
+
+    if (result.relType != RELTYPE_NONE) {
+        result.nXrefToRelative = record.nXrefTo;
+        result.nNextAddress = record.nXrefTo;
+    } else {
+        result.nXrefToMemory = record.nXrefTo;
+        result.nNextAddress = record.nAddress + record.nSize;
+    }
+
+    return result;
+}
+
+QList<XDisasmAbstract::DISASM_RESULT> XDisasmAbstract::_disasmList(char *pData, qint32 nDataSize, XADDR nAddress, const DISASM_OPTIONS &disasmOptions, qint32 nLimit,
+                                                                   XBinary::PDSTRUCT *pPdStruct)
+{
+    XDisasmListSink sink(nLimit);
+
+    _disasm(pData, nDataSize, nAddress, disasmOptions, &sink, pPdStruct);
+
+    return sink.getResults();
+}
+
+void XDisasmAbstract::_addDisasmResult(XDisasmSink *pSink, DISASM_RESULT &disasmResult, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions)
+{
     if (!(pState->bIsStop)) {
         if (disasmOptions.bIsUppercase) {
             disasmResult.sMnemonic = disasmResult.sMnemonic.toUpper();
             disasmResult.sOperands = disasmResult.sOperands.toUpper();
         }
 
-        pListResults->append(disasmResult);
+        // After the case change: the classes are those of the text that is shown
+        if (disasmOptions.bOperandTokens && (!disasmOptions.bLengthOnly)) {
+            tokenizeOperands(pState->dmFamily, disasmResult.sOperands, pState->syntax, &disasmResult.listOperandTokens);
+        }
+
+        if (!pSink->addDisasmResult(disasmResult)) {
+            pState->bIsStop = true;
+        }
+
         pState->nCurrentCount++;
         pState->nCurrentOffset += disasmResult.nSize;
     }
 
-    if ((pState->nLimit > 0) && (pState->nCurrentCount >= pState->nLimit)) {
-        pState->bIsStop = true;
-    } else if (pState->nCurrentOffset >= pState->nMaxSize) {
+    if (pState->nCurrentOffset >= pState->nMaxSize) {
         pState->bIsStop = true;
     }
 }
 
-void XDisasmAbstract::_addDisasmResult(QList<DISASM_RESULT> *pListResults, XADDR nAddress, qint32 nSize, const QString &sMnemonic, const QString &sString, STATE *pState,
+void XDisasmAbstract::_addDisasmResult(XDisasmSink *pSink, XADDR nAddress, qint32 nSize, const QString &sMnemonic, const QString &sString, STATE *pState,
                                        const XDisasmAbstract::DISASM_OPTIONS &disasmOptions)
 {
     DISASM_RESULT disasmResult = {};
@@ -99,476 +427,287 @@ void XDisasmAbstract::_addDisasmResult(QList<DISASM_RESULT> *pListResults, XADDR
     disasmResult.sMnemonic = sMnemonic;
     disasmResult.sOperands = sString;
 
-    _addDisasmResult(pListResults, disasmResult, pState, disasmOptions);
-}
-
-bool XDisasmAbstract::isBranchOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
-{
-    return isJumpOpcode(dmFamily, nOpcodeID) || isCondJumpOpcode(dmFamily, nOpcodeID) || isCallOpcode(dmFamily, nOpcodeID);
+    _addDisasmResult(pSink, disasmResult, pState, disasmOptions);
 }
 
-bool XDisasmAbstract::isJumpOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
+XDisasmAbstract::OPCODECLASS_TABLE XDisasmAbstract::getOpcodeClassTable(XBinary::DMFAMILY dmFamily)
 {
-    bool bResult = false;
+    static const QVector<quint16> listX86 = _buildOpcodeClassTable(X86_INS_ENDING, g_opcodeClassesX86, sizeof(g_opcodeClassesX86) / sizeof(OPCODECLASS_RECORD));
+    static const QVector<quint16> listARM = _buildOpcodeClassTable(ARM_INS_ENDING, g_opcodeClassesARM, sizeof(g_opcodeClassesARM) / sizeof(OPCODECLASS_RECORD));
+    static const QVector<quint16> listARM64 =
+        _buildOpcodeClassTable(ARM64_INS_ENDING, g_opcodeClassesARM64, sizeof(g_opcodeClassesARM64) / sizeof(OPCODECLASS_RECORD));
+    static const QVector<quint16> listBPF = _buildOpcodeClassTable(BPF_INS_ENDING, g_opcodeClassesBPF, sizeof(g_opcodeClassesBPF) / sizeof(OPCODECLASS_RECORD));
+    static const QVector<quint16> listSPARC =
+        _buildOpcodeClassTable(SPARC_INS_ENDING, g_opcodeClassesSPARC, sizeof(g_opcodeClassesSPARC) / sizeof(OPCODECLASS_RECORD));
+    static const QVector<quint16> listMIPS = _buildOpcodeClassTable(MIPS_INS_ENDING, g_opcodeClassesMIPS, sizeof(g_opcodeClassesMIPS) / sizeof(OPCODECLASS_RECORD));
+    static const QVector<quint16> listMOS65XX =
+        _buildOpcodeClassTable(MOS65XX_INS_ENDING, g_opcodeClassesMOS65XX, sizeof(g_opcodeClassesMOS65XX) / sizeof(OPCODECLASS_RECORD));
+    static const QVector<quint16> listM68K = _buildOpcodeClassTable(M68K_INS_ENDING, g_opcodeClassesM68K, sizeof(g_opcodeClassesM68K) / sizeof(OPCODECLASS_RECORD));
+    static const QVector<quint16> listPPC = _buildOpcodeClassTable(PPC_INS_ENDING, g_opcodeClassesPPC, sizeof(g_opcodeClassesPPC) / sizeof(OPCODECLASS_RECORD));
+    static const QVector<quint16> listWASM = _buildOpcodeClassTable(WASM_INS_ENDING, g_opcodeClassesWASM, sizeof(g_opcodeClassesWASM) / sizeof(OPCODECLASS_RECORD));
+
+    const QVector<quint16> *pList = nullptr;
 
     if (dmFamily == XBinary::DMFAMILY_X86) {
-        if (nOpcodeID == X86_INS_JMP) {
-            bResult = true;
-        }
+        pList = &listX86;
     } else if (dmFamily == XBinary::DMFAMILY_ARM) {
-        if ((nOpcodeID == ARM_INS_B) || (nOpcodeID == ARM_INS_BX)) {
-            bResult = true;
-        }
+        pList = &listARM;
     } else if (dmFamily == XBinary::DMFAMILY_ARM64) {
-        if ((nOpcodeID == ARM64_INS_B) || (nOpcodeID == ARM64_INS_BR)) {
-            bResult = true;
-        }
+        pList = &listARM64;
     } else if (dmFamily == XBinary::DMFAMILY_BPF) {
-        if (nOpcodeID == BPF_INS_JMP) {
-            bResult = true;
-        }
+        pList = &listBPF;
     } else if (dmFamily == XBinary::DMFAMILY_SPARC) {
-        if (nOpcodeID == SPARC_INS_JMP) {
-            bResult = true;
-        }
+        pList = &listSPARC;
     } else if (dmFamily == XBinary::DMFAMILY_MIPS) {
-        if (nOpcodeID == MIPS_INS_J) {
-            bResult = true;
-        }
+        pList = &listMIPS;
     } else if (dmFamily == XBinary::DMFAMILY_MOS65XX) {
-        if (nOpcodeID == MOS65XX_INS_JMP) {
-            bResult = true;
-        }
+        pList = &listMOS65XX;
     } else if (dmFamily == XBinary::DMFAMILY_M68K) {
-        if ((nOpcodeID == M68K_INS_BRA) || (nOpcodeID == M68K_INS_JMP)) {
-            bResult = true;
-        }
+        pList = &listM68K;
     } else if (dmFamily == XBinary::DMFAMILY_PPC) {
-        if ((nOpcodeID == PPC_INS_B) || (nOpcodeID == PPC_INS_BA)) {
-            bResult = true;
-        }
+        pList = &listPPC;
     } else if (dmFamily == XBinary::DMFAMILY_WASM) {
-        if (nOpcodeID == WASM_INS_BR) {
-            bResult = true;
-        }
+        pList = &listWASM;
     }
-
     // TODO Other archs
 
-    return bResult;
-}
-
-bool XDisasmAbstract::isRetOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
-{
-    bool bResult = false;
+    OPCODECLASS_TABLE result = {nullptr, 0};
 
-    if (dmFamily == XBinary::DMFAMILY_X86) {
-        if ((nOpcodeID == X86_INS_RET) || (nOpcodeID == X86_INS_RETF) || (nOpcodeID == X86_INS_RETFQ) || (nOpcodeID == X86_INS_IRET) || (nOpcodeID == X86_INS_IRETD) ||
-            (nOpcodeID == X86_INS_IRETQ)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_ARM64) {
-        if ((nOpcodeID == ARM64_INS_RET) || (nOpcodeID == ARM64_INS_RETAA) || (nOpcodeID == ARM64_INS_RETAB)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_BPF) {
-        if ((nOpcodeID == BPF_INS_RET) || (nOpcodeID == BPF_INS_EXIT)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_SPARC) {
-        if ((nOpcodeID == SPARC_INS_RET) || (nOpcodeID == SPARC_INS_RETL)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_MIPS) {
-        if ((nOpcodeID == MIPS_INS_JR) || (nOpcodeID == MIPS_INS_ERET)) {  // JR ra or exception return
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_MOS65XX) {
-        if ((nOpcodeID == MOS65XX_INS_RTS) || (nOpcodeID == MOS65XX_INS_RTI)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_M68K) {
-        if ((nOpcodeID == M68K_INS_RTS) || (nOpcodeID == M68K_INS_RTE) || (nOpcodeID == M68K_INS_RTR) || (nOpcodeID == M68K_INS_RTD)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_PPC) {
-        if (nOpcodeID == PPC_INS_BLR) {  // Branch to link register (return)
-            bResult = true;
-        }
+    if (pList) {
+        result.pClasses = pList->constData();
+        result.nNumberOfOpcodes = pList->count();
     }
-    // TODO Other archs
 
-    return bResult;
+    return result;
 }
 
-bool XDisasmAbstract::isPushOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
+quint16 XDisasmAbstract::getOpcodeClass(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
 {
-    bool bResult = false;
+    return getOpcodeClass(getOpcodeClassTable(dmFamily), nOpcodeID);
+}
 
-    if (dmFamily == XBinary::DMFAMILY_X86) {
-        if ((nOpcodeID == X86_INS_PUSH) || (nOpcodeID == X86_INS_PUSHF) || (nOpcodeID == X86_INS_PUSHFD) || (nOpcodeID == X86_INS_PUSHFQ)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_ARM) {
-        // PUSH exists for ARM Thumb; classic ARM uses STMDB SP! which Capstone decodes differently
-        if (nOpcodeID == ARM_INS_PUSH) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_M68K) {
-        // PEA pushes effective address onto the stack
-        if (nOpcodeID == M68K_INS_PEA) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_MOS65XX) {
-        // 6502 push instructions
-        if ((nOpcodeID == MOS65XX_INS_PHA) || (nOpcodeID == MOS65XX_INS_PHP)) {
-            bResult = true;
-        }
-    }
-    // TODO Other archs
+bool XDisasmAbstract::isBranchOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
+{
+    return (getOpcodeClass(dmFamily, nOpcodeID) & OPCODECLASS_BRANCH) != 0;
+}
 
-    return bResult;
+bool XDisasmAbstract::isJumpOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
+{
+    return (getOpcodeClass(dmFamily, nOpcodeID) & OPCODECLASS_JMP) != 0;
 }
 
-bool XDisasmAbstract::isPopOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
+bool XDisasmAbstract::isRetOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
 {
-    bool bResult = false;
+    return (getOpcodeClass(dmFamily, nOpcodeID) & OPCODECLASS_RET) != 0;
+}
 
-    if (dmFamily == XBinary::DMFAMILY_X86) {
-        if ((nOpcodeID == X86_INS_POP) || (nOpcodeID == X86_INS_POPF) || (nOpcodeID == X86_INS_POPFD) || (nOpcodeID == X86_INS_POPFQ)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_ARM) {
-        // POP exists for ARM Thumb
-        if (nOpcodeID == ARM_INS_POP) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_MOS65XX) {
-        // 6502/65xx pull instructions
-        if ((nOpcodeID == MOS65XX_INS_PLA) || (nOpcodeID == MOS65XX_INS_PLX) || (nOpcodeID == MOS65XX_INS_PLY) || (nOpcodeID == MOS65XX_INS_PLP)) {
-            bResult = true;
-        }
-    }
-    // TODO Other archs
+bool XDisasmAbstract::isPushOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
+{
+    return (getOpcodeClass(dmFamily, nOpcodeID) & OPCODECLASS_PUSH) != 0;
+}
 
-    return bResult;
+bool XDisasmAbstract::isPopOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
+{
+    return (getOpcodeClass(dmFamily, nOpcodeID) & OPCODECLASS_POP) != 0;
 }
 
 bool XDisasmAbstract::isCallOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
 {
-    bool bResult = false;
-
-    if (dmFamily == XBinary::DMFAMILY_X86) {
-        if (nOpcodeID == X86_INS_CALL) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_ARM) {
-        if ((nOpcodeID == ARM_INS_BL) || (nOpcodeID == ARM_INS_BLX)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_ARM64) {
-        if ((nOpcodeID == ARM64_INS_BL) || (nOpcodeID == ARM64_INS_BLR)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_MIPS) {
-        if ((nOpcodeID == MIPS_INS_JAL) || (nOpcodeID == MIPS_INS_JALR)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_SPARC) {
-        if ((nOpcodeID == SPARC_INS_CALL) || (nOpcodeID == SPARC_INS_JMPL)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_MOS65XX) {
-        if (nOpcodeID == MOS65XX_INS_JSR) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_M68K) {
-        if ((nOpcodeID == M68K_INS_BSR) || (nOpcodeID == M68K_INS_JSR)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_PPC) {
-        if ((nOpcodeID == PPC_INS_BL) || (nOpcodeID == PPC_INS_BLA)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_BPF) {
-        if (nOpcodeID == BPF_INS_CALL) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_WASM) {
-        if (nOpcodeID == WASM_INS_CALL) {
-            bResult = true;
-        }
-    }
-    // TODO Other archs
-
-    return bResult;
+    return (getOpcodeClass(dmFamily, nOpcodeID) & OPCODECLASS_CALL) != 0;
 }
 
 bool XDisasmAbstract::isCondJumpOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
 {
-    bool bResult = false;
-
-    if (dmFamily == XBinary::DMFAMILY_X86) {
-        if ((nOpcodeID == X86_INS_JA) || (nOpcodeID == X86_INS_JAE) || (nOpcodeID == X86_INS_JB) || (nOpcodeID == X86_INS_JBE) || (nOpcodeID == X86_INS_JCXZ) ||
-            (nOpcodeID == X86_INS_JE) || (nOpcodeID == X86_INS_JECXZ) || (nOpcodeID == X86_INS_JG) || (nOpcodeID == X86_INS_JGE) || (nOpcodeID == X86_INS_JL) ||
-            (nOpcodeID == X86_INS_JLE) || (nOpcodeID == X86_INS_JNE) || (nOpcodeID == X86_INS_JNO) || (nOpcodeID == X86_INS_JNP) || (nOpcodeID == X86_INS_JNS) ||
-            (nOpcodeID == X86_INS_JO) || (nOpcodeID == X86_INS_JP) || (nOpcodeID == X86_INS_JRCXZ) || (nOpcodeID == X86_INS_JS) || (nOpcodeID == X86_INS_LOOP) ||
-            (nOpcodeID == X86_INS_LOOPE) || (nOpcodeID == X86_INS_LOOPNE)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_MIPS) {
-        if ((nOpcodeID == MIPS_INS_BEQ) || (nOpcodeID == MIPS_INS_BNE) || (nOpcodeID == MIPS_INS_BGEZ) || (nOpcodeID == MIPS_INS_BGTZ) ||
-            (nOpcodeID == MIPS_INS_BLEZ) || (nOpcodeID == MIPS_INS_BLTZ)) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_PPC) {
-        if (nOpcodeID == PPC_INS_BC) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_BPF) {
-        if ((nOpcodeID == BPF_INS_JEQ) || (nOpcodeID == BPF_INS_JNE) || (nOpcodeID == BPF_INS_JGT) || (nOpcodeID == BPF_INS_JGE) || (nOpcodeID == BPF_INS_JLT) ||
-            (nOpcodeID == BPF_INS_JLE) || (nOpcodeID == BPF_INS_JSET) || (nOpcodeID == BPF_INS_JSGT) || (nOpcodeID == BPF_INS_JSGE)) {
-            bResult = true;
-        }
-    }
-    // TODO ARM/ARM64 condition codes live in cs_detail (arm.cc/arm64.cc), not the opcode id; and emitting
-    // RELTYPE_JMP_COND + nXrefToRelative for these families also needs per-arch operand extraction in Capstone_Bridge.
-
-    return bResult;
+    return (getOpcodeClass(dmFamily, nOpcodeID) & OPCODECLASS_CONDJMP) != 0;
 }
 
 bool XDisasmAbstract::isNopOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
 {
-    bool bResult = false;
-
-    if (dmFamily == XBinary::DMFAMILY_X86) {
-        if (nOpcodeID == X86_INS_NOP) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_ARM) {
-        if (nOpcodeID == ARM_INS_NOP) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_ARM64) {
-        if (nOpcodeID == ARM64_INS_NOP) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_M68K) {
-        if (nOpcodeID == M68K_INS_NOP) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_MOS65XX) {
-        if (nOpcodeID == MOS65XX_INS_NOP) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_MIPS) {
-        if (nOpcodeID == MIPS_INS_NOP) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_SPARC) {
-        if (nOpcodeID == SPARC_INS_NOP) {
-            bResult = true;
-        }
-    } else if (dmFamily == XBinary::DMFAMILY_WASM) {
-        if (nOpcodeID == WASM_INS_NOP) {
-            bResult = true;
-        }
-    }
-
-    return bResult;
+    return (getOpcodeClass(dmFamily, nOpcodeID) & OPCODECLASS_NOP) != 0;
 }
 
 bool XDisasmAbstract::isInt3Opcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
 {
-    // TODO Other archs
-    return (dmFamily == XBinary::DMFAMILY_X86) && (nOpcodeID == X86_INS_INT3);
+    return (getOpcodeClass(dmFamily, nOpcodeID) & OPCODECLASS_INT3) != 0;
 }
 
 bool XDisasmAbstract::isSyscallOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID)
 {
-    // TODO Other archs
-    return (dmFamily == XBinary::DMFAMILY_X86) && (nOpcodeID == X86_INS_SYSCALL);
+    return (getOpcodeClass(dmFamily, nOpcodeID) & OPCODECLASS_SYSCALL) != 0;
 }
 
-bool XDisasmAbstract::isGeneralRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
+quint16 XDisasmAbstract::getOperandClass(XBinary::DMFAMILY dmFamily, const QChar *pData, qint32 nSize, XBinary::SYNTAX syntax)
 {
-    bool bResult = false;
+    quint16 nResult = 0;
+
+    for (qint32 i = 0; i < nSize; i++) {
+        if (pData[i] == QChar('<')) {
+            nResult |= OPERANDCLASS_REF;
+            break;
+        }
+    }
 
     if (dmFamily == XBinary::DMFAMILY_X86) {
-        QString _sRegister = sRegister;
+        // Register name without the AT&T '%'; in AT&T syntax a token without it is not a register
+        const QChar *pName = pData;
+        qint32 nNameSize = nSize;
 
         if (syntax == XBinary::SYNTAX_ATT) {
-            qint32 nSize = sRegister.size();
-
-            if (nSize >= 2) {
-                if (_sRegister.at(0) == QChar('%')) {
-                    bResult = true;
-                    _sRegister = _sRegister.right(_sRegister.size() - 1);
-                }
+            if ((nSize >= 2) && (pData[0] == QChar('%'))) {
+                pName++;
+                nNameSize--;
+            } else {
+                nNameSize = 0;
             }
-        } else {
-            bResult = true;
         }
 
-        if (bResult) {
-            if ((_sRegister == "al") || (_sRegister == "ah") || (_sRegister == "bl") || (_sRegister == "bh") || (_sRegister == "cl") || (_sRegister == "ch") ||
-                (_sRegister == "dl") || (_sRegister == "dh") || (_sRegister == "ax") || (_sRegister == "bx") || (_sRegister == "cx") || (_sRegister == "dx") ||
-                (_sRegister == "si") || (_sRegister == "di") || (_sRegister == "sp") || (_sRegister == "bp") || (_sRegister == "eax") || (_sRegister == "ebx") ||
-                (_sRegister == "ecx") || (_sRegister == "edx") || (_sRegister == "esi") || (_sRegister == "edi") || (_sRegister == "esp") || (_sRegister == "ebp") ||
-                (_sRegister == "rax") || (_sRegister == "rbx") || (_sRegister == "rcx") || (_sRegister == "rdx") || (_sRegister == "rsi") || (_sRegister == "rdi") ||
-                (_sRegister == "rsp") || (_sRegister == "rbp") || (_sRegister == "r8") || (_sRegister == "r9") || (_sRegister == "r10") || (_sRegister == "r11") ||
-                (_sRegister == "r12") || (_sRegister == "r13") || (_sRegister == "r14") || (_sRegister == "r15") || (_sRegister == "r8b") || (_sRegister == "r9b") ||
-                (_sRegister == "r10b") || (_sRegister == "r11b") || (_sRegister == "r12b") || (_sRegister == "r13b") || (_sRegister == "r14b") ||
-                (_sRegister == "r15b") || (_sRegister == "r8d") || (_sRegister == "r9d") || (_sRegister == "r10d") || (_sRegister == "r11d") || (_sRegister == "r12d") ||
-                (_sRegister == "r13d") || (_sRegister == "r14d") || (_sRegister == "r15d")) {
-                bResult = true;
-            } else {
-                bResult = false;
-            }
+        static const QHash<quint64, quint16> mapRegisterClasses = _buildRegisterClassesX86();
+
+        quint64 nKey = _packRegisterName(pName, nNameSize);
+
+        if (nKey) {
+            nResult |= mapRegisterClasses.value(nKey, 0);
         }
-    } else if (dmFamily == XBinary::DMFAMILY_ARM) {
-        bResult = (sRegister.size() >= 2) && (sRegister.at(0) == QChar('r'));
-    } else if (dmFamily == XBinary::DMFAMILY_ARM64) {
-        // Accept both the 64-bit ('x') and 32-bit ('w') general-register views (covers xzr/wzr).
-        bResult = (sRegister.size() >= 2) && ((sRegister.at(0) == QChar('x')) || (sRegister.at(0) == QChar('w')));
-    }
-    // TODO Other archs
 
-    return bResult;
-}
+        // The GUI operand tokenizer splits on '(' / ')', so an Intel operand "st(0)" arrives as bare "st" (in the table);
+        // the whole-operand form st(0..7) comes from isRegister callers.
+        if ((nNameSize >= 4) && (pName[0] == QChar('s')) && (pName[1] == QChar('t')) && (pName[2] == QChar('(')) && (pName[nNameSize - 1] == QChar(')'))) {
+            nResult |= OPERANDCLASS_FPU;
+        }
 
-bool XDisasmAbstract::isStackRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
-{
-    bool bResult = false;
+        if ((nNameSize >= 3) && (pName[0] == QChar('x')) && (pName[1] == QChar('m')) && (pName[2] == QChar('m'))) {
+            nResult |= OPERANDCLASS_XMM;
+        }
 
-    if (dmFamily == XBinary::DMFAMILY_X86) {
-        const QString _sRegister = removeRegPrefix(dmFamily, sRegister, syntax);
+        bool bIsNumber = false;
+
+        if ((syntax == XBinary::SYNTAX_DEFAULT) || (syntax == XBinary::SYNTAX_INTEL)) {
+            bIsNumber = (nSize == 1) || ((nSize >= 2) && (((pData[0] == QChar('0')) && (pData[1] == QChar('x'))) || (pData[0] == QChar('-'))));
+        } else if (syntax == XBinary::SYNTAX_MASM) {
+            bIsNumber = (nSize == 1) || ((nSize > 1) && (pData[nSize - 1] == QChar('h')));
+        } else if (syntax == XBinary::SYNTAX_ATT) {
+            if ((nSize >= 2) && (pData[0] == QChar('$'))) {
+                bIsNumber = true;
+
+                for (qint32 i = 0; (i + 1) < nSize; i++) {
+                    if ((pData[i] == QChar(',')) && (pData[i + 1] == QChar(' '))) {
+                        bIsNumber = false;
+                        break;
+                    }
+                }
+            }
+        }
 
-        if (!_sRegister.isEmpty()) {
-            bResult = (_sRegister == "sp") || (_sRegister == "bp") || (_sRegister == "esp") || (_sRegister == "ebp") || (_sRegister == "rsp") || (_sRegister == "rbp");
+        if (bIsNumber) {
+            nResult |= OPERANDCLASS_NUMBER;
         }
     } else if ((dmFamily == XBinary::DMFAMILY_ARM) || (dmFamily == XBinary::DMFAMILY_ARM64)) {
-        if (sRegister == "sp") {
-            bResult = true;
+        if (nSize >= 2) {
+            if (dmFamily == XBinary::DMFAMILY_ARM) {
+                if (pData[0] == QChar('r')) {
+                    nResult |= OPERANDCLASS_GENERAL;
+                }
+            } else {
+                // Both the 64-bit ('x') and 32-bit ('w') general-register views (covers xzr/wzr)
+                if ((pData[0] == QChar('x')) || (pData[0] == QChar('w'))) {
+                    nResult |= OPERANDCLASS_GENERAL;
+                }
+            }
+
+            if (nSize == 2) {
+                if ((pData[0] == QChar('s')) && (pData[1] == QChar('p'))) {
+                    nResult |= OPERANDCLASS_STACK;
+                } else if ((pData[0] == QChar('p')) && (pData[1] == QChar('c'))) {
+                    nResult |= OPERANDCLASS_IP;
+                }
+            }
         }
+        // TODO numbers
     }
     // TODO Other archs
 
-    return bResult;
+    return nResult;
 }
 
-bool XDisasmAbstract::isSegmentRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
+void XDisasmAbstract::tokenizeOperands(XBinary::DMFAMILY dmFamily, const QString &sOperands, XBinary::SYNTAX syntax, QVector<OPERAND_TOKEN> *pListTokens)
 {
-    bool bResult = false;
+    pListTokens->clear();
 
-    if (dmFamily == XBinary::DMFAMILY_X86) {
-        const QString _sRegister = removeRegPrefix(dmFamily, sRegister, syntax);
+    qint32 nNumberOfChars = sOperands.size();
 
-        if (!_sRegister.isEmpty()) {
-            bResult = (_sRegister == "es") || (_sRegister == "gs") || (_sRegister == "ss") || (_sRegister == "ds") || (_sRegister == "cs") || (_sRegister == "fs");
-        }
-    }
-    // TODO Other archs
+    if (nNumberOfChars <= 0xFFFF) {
+        const QChar *pOperands = sOperands.constData();
+        qint32 nStart = 0;
+        bool bIsSeparator = false;
 
-    return bResult;
-}
+        for (qint32 i = 0; i <= nNumberOfChars; i++) {
+            bool bIsEnd = (i == nNumberOfChars);
+            bool _bIsSeparator = false;
 
-bool XDisasmAbstract::isDebugRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
-{
-    bool bResult = false;
+            if (!bIsEnd) {
+                ushort nChar = pOperands[i].unicode();
+                _bIsSeparator = (nChar == ',') || (nChar == '[') || (nChar == ']') || (nChar == '+') || (nChar == '-') || (nChar == '*') || (nChar == '(') ||
+                                (nChar == ')') || (nChar == ':') || (nChar == ' ');
+            }
 
-    if (dmFamily == XBinary::DMFAMILY_X86) {
-        const QString _sRegister = removeRegPrefix(dmFamily, sRegister, syntax);
+            if ((i > nStart) && (bIsEnd || (_bIsSeparator != bIsSeparator))) {
+                OPERAND_TOKEN token = {};
+                token.nOffset = (quint16)nStart;
+                token.nSize = (quint16)(i - nStart);
+                token.nClass = bIsSeparator ? (quint16)OPERANDCLASS_SEPARATOR : getOperandClass(dmFamily, pOperands + nStart, i - nStart, syntax);
+
+                pListTokens->append(token);
+                nStart = i;
+            }
 
-        if (!_sRegister.isEmpty()) {
-            bResult = (_sRegister == "dr0") || (_sRegister == "dr1") || (_sRegister == "dr2") || (_sRegister == "dr3") || (_sRegister == "dr6") ||
-                      (_sRegister == "dr7");
+            bIsSeparator = _bIsSeparator;
         }
     }
-    // TODO Other archs
+}
 
-    return bResult;
+bool XDisasmAbstract::isGeneralRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
+{
+    return (getOperandClass(dmFamily, sRegister.constData(), sRegister.size(), syntax) & OPERANDCLASS_GENERAL) != 0;
 }
 
-bool XDisasmAbstract::isInstructionPointerRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
+bool XDisasmAbstract::isStackRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
 {
-    bool bResult = false;
+    return (getOperandClass(dmFamily, sRegister.constData(), sRegister.size(), syntax) & OPERANDCLASS_STACK) != 0;
+}
 
-    if (dmFamily == XBinary::DMFAMILY_X86) {
-        const QString _sRegister = removeRegPrefix(dmFamily, sRegister, syntax);
+bool XDisasmAbstract::isSegmentRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
+{
+    return (getOperandClass(dmFamily, sRegister.constData(), sRegister.size(), syntax) & OPERANDCLASS_SEGMENT) != 0;
+}
 
-        if (!_sRegister.isEmpty()) {
-            bResult = (_sRegister == "ip") || (_sRegister == "eip") || (_sRegister == "rip");
-        }
-    } else if ((dmFamily == XBinary::DMFAMILY_ARM) || (dmFamily == XBinary::DMFAMILY_ARM64)) {
-        if (sRegister == "pc") {
-            bResult = true;
-        }
-    }
-    // TODO Other archs
+bool XDisasmAbstract::isDebugRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
+{
+    return (getOperandClass(dmFamily, sRegister.constData(), sRegister.size(), syntax) & OPERANDCLASS_DEBUG) != 0;
+}
 
-    return bResult;
+bool XDisasmAbstract::isInstructionPointerRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
+{
+    return (getOperandClass(dmFamily, sRegister.constData(), sRegister.size(), syntax) & OPERANDCLASS_IP) != 0;
 }
 
 bool XDisasmAbstract::isFlagsRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
 {
-    bool bResult = false;
-
-    if (dmFamily == XBinary::DMFAMILY_X86) {
-        const QString _sRegister = removeRegPrefix(dmFamily, sRegister, syntax);
-
-        if (!_sRegister.isEmpty()) {
-            bResult = (_sRegister == "flags") || (_sRegister == "eflags") || (_sRegister == "rflags");
-        }
-    }
-    // TODO Other archs
-
-    return bResult;
+    return (getOperandClass(dmFamily, sRegister.constData(), sRegister.size(), syntax) & OPERANDCLASS_FLAGS) != 0;
 }
 
 bool XDisasmAbstract::isFPURegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
 {
-    bool bResult = false;
-
-    if (dmFamily == XBinary::DMFAMILY_X86) {
-        const QString _sRegister = removeRegPrefix(dmFamily, sRegister, syntax);
-
-        if (!_sRegister.isEmpty()) {
-            // The GUI operand tokenizer splits on '(' / ')', so an Intel operand "st(0)" arrives here as bare "st".
-            // Also accept the whole-operand forms st(0..7) (from isRegister callers) and the un-parenthesized st0..st7.
-            bResult = (_sRegister == "st") || (_sRegister.startsWith(QLatin1String("st(")) && _sRegister.endsWith(QChar(')')));
-
-            if (!bResult && (_sRegister.size() == 3) && _sRegister.startsWith(QLatin1String("st"))) {
-                const QChar cLast = _sRegister.at(2);
-                bResult = (cLast >= QChar('0')) && (cLast <= QChar('7'));
-            }
-        }
-    }
-    // TODO Other archs
-
-    return bResult;
+    return (getOperandClass(dmFamily, sRegister.constData(), sRegister.size(), syntax) & OPERANDCLASS_FPU) != 0;
 }
 
 bool XDisasmAbstract::isXMMRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
 {
-    bool bResult = false;
-
-    if (dmFamily == XBinary::DMFAMILY_X86) {
-        if (syntax == XBinary::SYNTAX_ATT) {
-            bResult = sRegister.startsWith(QLatin1String("%xmm"));
-        } else {
-            bResult = sRegister.startsWith(QLatin1String("xmm"));
-        }
-    }
-
-    return bResult;
+    return (getOperandClass(dmFamily, sRegister.constData(), sRegister.size(), syntax) & OPERANDCLASS_XMM) != 0;
 }
 
 bool XDisasmAbstract::isRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
 {
-    return (isGeneralRegister(dmFamily, sRegister, syntax) || isSegmentRegister(dmFamily, sRegister, syntax) || isDebugRegister(dmFamily, sRegister, syntax) ||
-            isInstructionPointerRegister(dmFamily, sRegister, syntax) || isFlagsRegister(dmFamily, sRegister, syntax) || isFPURegister(dmFamily, sRegister, syntax) ||
-            isXMMRegister(dmFamily, sRegister, syntax));
+    return (getOperandClass(dmFamily, sRegister.constData(), sRegister.size(), syntax) & OPERANDCLASS_REGISTER) != 0;
 }
 
 bool XDisasmAbstract::isRef(XBinary::DMFAMILY dmFamily, const QString &sOperand, XBinary::SYNTAX syntax)
@@ -581,41 +720,7 @@ bool XDisasmAbstract::isRef(XBinary::DMFAMILY dmFamily, const QString &sOperand,
 
 bool XDisasmAbstract::isNumber(XBinary::DMFAMILY dmFamily, const QString &sNumber, XBinary::SYNTAX syntax)
 {
-    bool bResult = false;
-
-    if (dmFamily == XBinary::DMFAMILY_X86) {
-        if ((syntax == XBinary::SYNTAX_DEFAULT) || (syntax == XBinary::SYNTAX_INTEL)) {
-            qint32 nSize = sNumber.size();
-            if (nSize == 1) {
-                bResult = true;
-            } else if (nSize >= 2) {
-                if (sNumber.left(2) == "0x") {
-                    bResult = true;
-                } else if (sNumber.at(0) == QChar('-')) {
-                    bResult = true;
-                }
-            }
-        } else if (syntax == XBinary::SYNTAX_MASM) {
-            qint32 nSize = sNumber.size();
-            if (nSize == 1) {
-                bResult = true;
-            } else if (nSize > 1) {
-                if (sNumber.right(1) == "h") {
-                    bResult = true;
-                }
-            }
-        } else if (syntax == XBinary::SYNTAX_ATT) {
-            qint32 nSize = sNumber.size();
-            if ((nSize >= 2) && (sNumber.at(0) == QChar('$')) && (!sNumber.contains(", "))) {
-                bResult = true;
-            }
-        }
-    } else if ((dmFamily == XBinary::DMFAMILY_ARM) || (dmFamily == XBinary::DMFAMILY_ARM64)) {
-        // TODO
-    }
-    // TODO Other archs
-
-    return bResult;
+    return (getOperandClass(dmFamily, sNumber.constData(), sNumber.size(), syntax) & OPERANDCLASS_NUMBER) != 0;
 }
 
 QString XDisasmAbstract::removeRegPrefix(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax)
@@ -638,3 +743,45 @@ QString XDisasmAbstract::removeRegPrefix(XBinary::DMFAMILY dmFamily, const QStri
 
     return sResult;
 }
+
+XDisasmListSink::XDisasmListSink(qint32 nLimit)
+{
+    m_nLimit = nLimit;
+}
+
+bool XDisasmListSink::addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult)
+{
+    if ((m_nLimit == 0) && (!disasmResult.bIsValid)) {
+        return false;
+    }
+
+    m_listResults.append(disasmResult);
+
+    return !((m_nLimit > 0) && (m_listResults.count() >= m_nLimit));
+}
+
+QList<XDisasmAbstract::DISASM_RESULT> XDisasmListSink::getResults()
+{
+    return m_listResults;
+}
+
+XDisasmRecordSink::XDisasmRecordSink(qint32 nLimit)
+{
+    m_nLimit = nLimit;
+}
+
+bool XDisasmRecordSink::addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult)
+{
+    if ((m_nLimit == 0) && (!disasmResult.bIsValid)) {
+        return false;
+    }
+
+    m_listRecords.append(XDisasmAbstract::toRecord(disasmResult));
+
+    return !((m_nLimit > 0) && (m_listRecords.count() >= m_nLimit));
+}
+
+QVector<XDisasmAbstract::DISASM_RECORD> XDisasmRecordSink::getRecords()
+{
+    return m_listRecords;
+}
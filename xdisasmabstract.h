@@ -25,6 +25,8 @@
 #include "xbinary.h"
 #include "xcapstone.h"
 
+class XDisasmSink;
+
 class XDisasmAbstract : public QObject {
     Q_OBJECT
 
@@ -32,11 +34,12 @@ public:
     struct STATE {
         bool bIsStop;
         XADDR nAddress;
-        qint32 nLimit;
         qint64 nMaxSize;
         qint32 nCurrentCount;
         qint64 nCurrentOffset;
         qint64 nNumberOfFolders;  // 7z backend: folder count carried from UnpackInfo to SubStreamsInfo
+        XBinary::DMFAMILY dmFamily;  // Operand token classes (bOperandTokens); left 0 by backends without registers
+        XBinary::SYNTAX syntax;
     };
 
     enum RELTYPE : quint32 {
@@ -55,6 +58,13 @@ public:
         MEMTYPE_ACCESS
     };
 
+    // A span of sOperands: a token or a run of separator characters
+    struct OPERAND_TOKEN {
+        quint16 nOffset;
+        quint16 nSize;
+        quint16 nClass;  // OPERANDCLASS_*
+    };
+
     struct DISASM_RESULT {
         bool bIsValid;
         bool bMemError;
@@ -78,20 +88,99 @@ public:
         quint32 nDispSize;
         quint32 nImmOffset;
         quint32 nImmSize;
+        QVector<OPERAND_TOKEN> listOperandTokens;  // With bOperandTokens
+    };
+
+    enum RECFLAG : quint8 {
+        RECFLAG_VALID = 0x01,
+        RECFLAG_MEMERROR = 0x02,
+        RECFLAG_CONST = 0x04,
+        RECFLAG_RET = 0x08,
+        RECFLAG_CALL = 0x10,
+        RECFLAG_JMP = 0x20,
+        RECFLAG_CONDJMP = 0x40
+    };
+
+    // Compact, trivially copyable DISASM_RESULT without text (32 bytes). The mnemonic and operands are
+    // produced on demand by re-decoding, see XDisasmCore::formatRecord.
+    struct DISASM_RECORD {
+        XADDR nAddress;
+        XADDR nXrefTo;  // nXrefToRelative if nRelType != RELTYPE_NONE, else nXrefToMemory
+        quint32 nSize;
+        quint16 nOpcode;
+        quint8 nFlags;  // RECFLAG_*
+        quint8 nRelType;
+        quint8 nMemType;
+        quint8 nMemorySize;
+        quint8 nDispOffset;
+        quint8 nDispSize;
+        quint8 nImmOffset;
+        quint8 nImmSize;
+    };
+
+    // Opcode classes of a family, see getOpcodeClassTable
+    enum OPCODECLASS : quint16 {
+        OPCODECLASS_JMP = 0x0001,
+        OPCODECLASS_CONDJMP = 0x0002,
+        OPCODECLASS_CALL = 0x0004,
+        OPCODECLASS_RET = 0x0008,
+        OPCODECLASS_PUSH = 0x0010,
+        OPCODECLASS_POP = 0x0020,
+        OPCODECLASS_NOP = 0x0040,
+        OPCODECLASS_INT3 = 0x0080,
+        OPCODECLASS_SYSCALL = 0x0100,
+        OPCODECLASS_BRANCH = OPCODECLASS_JMP | OPCODECLASS_CONDJMP | OPCODECLASS_CALL
+    };
+
+    // Operand token classes, see getOperandClass
+    enum OPERANDCLASS : quint16 {
+        OPERANDCLASS_REF = 0x0001,
+        OPERANDCLASS_GENERAL = 0x0002,
+        OPERANDCLASS_STACK = 0x0004,
+        OPERANDCLASS_SEGMENT = 0x0008,
+        OPERANDCLASS_DEBUG = 0x0010,
+        OPERANDCLASS_IP = 0x0020,
+        OPERANDCLASS_FLAGS = 0x0040,
+        OPERANDCLASS_FPU = 0x0080,
+        OPERANDCLASS_XMM = 0x0100,
+        OPERANDCLASS_NUMBER = 0x0200,
+        OPERANDCLASS_SEPARATOR = 0x0400,
+        OPERANDCLASS_REGISTER = OPERANDCLASS_GENERAL | OPERANDCLASS_SEGMENT | OPERANDCLASS_DEBUG | OPERANDCLASS_IP | OPERANDCLASS_FLAGS | OPERANDCLASS_FPU |
+                                OPERANDCLASS_XMM  // as isRegister: a stack-only register (ARM sp) is not included
+    };
+
+    // OPCODECLASS_* bits indexed by the Capstone instruction id; built once per family
+    struct OPCODECLASS_TABLE {
+        const quint16 *pClasses;
+        quint32 nNumberOfOpcodes;
     };
 
     struct DISASM_OPTIONS {
         bool bIsUppercase;
         bool bNoStrings;
+        bool bLengthOnly;  // Skip sMnemonic/sOperands: size, opcode id, flow flags, xrefs and encoding offsets only
+        bool bNoXrefs;     // With bLengthOnly: xrefs and encoding offsets are not needed either (detail-less decode)
+        bool bOperandTokens;  // Fill listOperandTokens, so rendering does not tokenize sOperands again
     };
 
     explicit XDisasmAbstract(QObject *pParent = nullptr);
     virtual ~XDisasmAbstract() = default;
-    virtual QList<DISASM_RESULT> _disasm(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, qint32 nLimit,
-                                         XBinary::PDSTRUCT *pPdStruct) = 0;
+    // Backends push results one at a time; the sink decides when to stop (limit, early exit, ...).
+    virtual void _disasm(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink,
+                         XBinary::PDSTRUCT *pPdStruct) = 0;
+    QList<DISASM_RESULT> _disasmList(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, qint32 nLimit,
+                                     XBinary::PDSTRUCT *pPdStruct);
 
     static QString getNumberString(qint64 nValue, XBinary::DM disasmMode, XBinary::SYNTAX syntax);
     static QString getOpcodeFullString(const DISASM_RESULT &disasmResult);
+    static DISASM_RECORD toRecord(const DISASM_RESULT &disasmResult);
+    static DISASM_RESULT fromRecord(const DISASM_RECORD &record);
+    static OPCODECLASS_TABLE getOpcodeClassTable(XBinary::DMFAMILY dmFamily);
+    static inline quint16 getOpcodeClass(const OPCODECLASS_TABLE &table, quint32 nOpcodeID)
+    {
+        return (nOpcodeID < table.nNumberOfOpcodes) ? table.pClasses[nOpcodeID] : 0;
+    }
+    static quint16 getOpcodeClass(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID);
     static bool isBranchOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID);  // mb TODO rename
     static bool isJumpOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID);
     static bool isRetOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID);
@@ -102,6 +191,10 @@ public:
     static bool isNopOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID);
     static bool isInt3Opcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID);
     static bool isSyscallOpcode(XBinary::DMFAMILY dmFamily, quint32 nOpcodeID);
+    // All OPERANDCLASS_* bits of a token (or a whole operand) without building a QString
+    static quint16 getOperandClass(XBinary::DMFAMILY dmFamily, const QChar *pData, qint32 nSize, XBinary::SYNTAX syntax);
+    // Splits on ",[]+-*(): " as the operand renderer does; nothing is added for text longer than 0xFFFF
+    static void tokenizeOperands(XBinary::DMFAMILY dmFamily, const QString &sOperands, XBinary::SYNTAX syntax, QVector<OPERAND_TOKEN> *pListTokens);
     static bool isGeneralRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax);
     static bool isStackRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax);
     static bool isSegmentRegister(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax);
@@ -116,9 +209,41 @@ public:
 
     static QString removeRegPrefix(XBinary::DMFAMILY dmFamily, const QString &sRegister, XBinary::SYNTAX syntax);
 
-    void _addDisasmResult(QList<DISASM_RESULT> *pListResults, DISASM_RESULT &disasmResult, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
-    void _addDisasmResult(QList<DISASM_RESULT> *pListResults, XADDR nAddress, qint32 nSize, const QString &sMnemonic, const QString &sString, STATE *pState,
+    void _addDisasmResult(XDisasmSink *pSink, DISASM_RESULT &disasmResult, STATE *pState, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
+    void _addDisasmResult(XDisasmSink *pSink, XADDR nAddress, qint32 nSize, const QString &sMnemonic, const QString &sString, STATE *pState,
                           const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
 };
 
+class XDisasmSink {
+public:
+    virtual ~XDisasmSink() = default;
+    // Return false to stop the backend.
+    virtual bool addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult) = 0;
+};
+
+// nLimit: -1 no limit; 0 stop at the first invalid result; N stop after N results
+class XDisasmListSink : public XDisasmSink {
+public:
+    explicit XDisasmListSink(qint32 nLimit = -1);
+
+    virtual bool addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult);
+    QList<XDisasmAbstract::DISASM_RESULT> getResults();
+
+private:
+    qint32 m_nLimit;
+    QList<XDisasmAbstract::DISASM_RESULT> m_listResults;
+};
+
+class XDisasmRecordSink : public XDisasmSink {
+public:
+    explicit XDisasmRecordSink(qint32 nLimit = -1);
+
+    virtual bool addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult);
+    QVector<XDisasmAbstract::DISASM_RECORD> getRecords();
+
+private:
+    qint32 m_nLimit;
+    QVector<XDisasmAbstract::DISASM_RECORD> m_listRecords;
+};
+
 #endif  // XDISASMABSTRACT_H
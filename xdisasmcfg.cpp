@@ -0,0 +1,458 @@
+/* Copyright (c) 2025-2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "xdisasmcfg.h"
+
+#include <algorithm>
+
+const qint64 N_CFG_TRACE_WINDOW = 0x40000000;  // _disasm takes a qint32 size
+const qint32 N_CFG_CLAIM_SHARDS = 64;          // Must be a power of two
+
+// Instruction start -> function that claimed it; sharded by address so the workers rarely wait on each other
+struct CFG_CLAIM_SHARD {
+    QMutex mutex;
+    QHash<XADDR, XADDR> mapClaims;
+};
+
+// State shared by the workers of one build; the members below the mutex are guarded by it.
+struct CFG_CONTEXT {
+    const XDisasmCore *pDisasmCore;
+    QVector<XDisasmCore::MEMORY_REGION> listRegions;  // Sorted by address
+    XBinary::PDSTRUCT *pPdStruct;
+    CFG_CLAIM_SHARD claimShards[N_CFG_CLAIM_SHARDS];
+    QMutex mutex;
+    QWaitCondition waitCondition;
+    QSet<XADDR> setFunctions;
+    QList<XADDR> listFunctionQueue;
+    qint32 nNumberOfBusy;
+    bool bIsStop;
+};
+
+static bool _isCondBranch(const XDisasmAbstract::DISASM_RECORD &record)
+{
+    bool bResult = false;
+
+    if (record.nFlags & XDisasmAbstract::RECFLAG_CONDJMP) {
+        bResult = true;
+    } else if (record.nFlags & (XDisasmAbstract::RECFLAG_JMP | XDisasmAbstract::RECFLAG_CALL | XDisasmAbstract::RECFLAG_RET)) {
+        bResult = false;
+    } else {
+        // Backends without flow flags (no opcode class table) only give the rel type; a plain RELTYPE_JMP may be
+        // conditional, so the fall-through is kept.
+        bResult = (record.nRelType == XDisasmAbstract::RELTYPE_JMP_COND) || (record.nRelType == XDisasmAbstract::RELTYPE_JMP);
+    }
+
+    return bResult;
+}
+
+static bool _isBlockEnd(const XDisasmAbstract::DISASM_RECORD &record)
+{
+    return (record.nFlags & (XDisasmAbstract::RECFLAG_RET | XDisasmAbstract::RECFLAG_JMP)) || _isCondBranch(record);
+}
+
+static bool _findRegion(const QVector<XDisasmCore::MEMORY_REGION> &listRegions, XADDR nAddress, char **ppData, qint32 *pnSize)
+{
+    bool bResult = false;
+
+    qint32 nLow = 0;
+    qint32 nHigh = listRegions.count();
+
+    while (nLow < nHigh) {
+        qint32 nMiddle = (nLow + nHigh) / 2;
+
+        if (listRegions.at(nMiddle).nAddress <= nAddress) {
+            nLow = nMiddle + 1;
+        } else {
+            nHigh = nMiddle;
+        }
+    }
+
+    if (nLow > 0) {
+        const XDisasmCore::MEMORY_REGION &region = listRegions.at(nLow - 1);
+        qint64 nDelta = (qint64)(nAddress - region.nAddress);
+
+        if (nDelta < region.nSize) {
+            *ppData = region.pData + nDelta;
+            *pnSize = (qint32)qMin(region.nSize - nDelta, N_CFG_TRACE_WINDOW);
+            bResult = true;
+        }
+    }
+
+    return bResult;
+}
+
+static CFG_CLAIM_SHARD *_getClaimShard(CFG_CONTEXT *pContext, XADDR nAddress)
+{
+    return &(pContext->claimShards[qHash(nAddress) & (N_CFG_CLAIM_SHARDS - 1)]);
+}
+
+static bool _claim(CFG_CONTEXT *pContext, XADDR nAddress, XADDR nFunction)
+{
+    bool bResult = false;
+
+    CFG_CLAIM_SHARD *pShard = _getClaimShard(pContext, nAddress);
+
+    QMutexLocker locker(&pShard->mutex);
+
+    if (!pShard->mapClaims.contains(nAddress)) {
+        pShard->mapClaims.insert(nAddress, nFunction);
+        bResult = true;
+    }
+
+    return bResult;
+}
+
+// After the workers are done: no locking
+static bool _getClaim(CFG_CONTEXT *pContext, XADDR nAddress, XADDR *pnFunction)
+{
+    bool bResult = false;
+
+    CFG_CLAIM_SHARD *pShard = _getClaimShard(pContext, nAddress);
+
+    QHash<XADDR, XADDR>::const_iterator iter = pShard->mapClaims.constFind(nAddress);
+
+    if (iter != pShard->mapClaims.constEnd()) {
+        *pnFunction = iter.value();
+        bResult = true;
+    }
+
+    return bResult;
+}
+
+static void _addFunction(CFG_CONTEXT *pContext, XADDR nAddress)
+{
+    QMutexLocker locker(&pContext->mutex);
+
+    if (!pContext->setFunctions.contains(nAddress)) {
+        pContext->setFunctions.insert(nAddress);
+        pContext->listFunctionQueue.append(nAddress);
+        pContext->waitCondition.wakeOne();
+    }
+}
+
+// Collects one straight-line trace. An address is claimed only once a valid instruction was decoded there, so
+// a trace stops as soon as it runs into code another trace already owns, and no claim is left without a record
+// (a stream that ends at a region boundary or on invalid bytes claims nothing past its last instruction).
+class XDisasmTraceSink : public XDisasmSink {
+public:
+    XDisasmTraceSink(CFG_CONTEXT *pContext, XADDR nFunction, QVector<XDisasmAbstract::DISASM_RECORD> *pListRecords)
+    {
+        m_pContext = pContext;
+        m_nFunction = nFunction;
+        m_pListRecords = pListRecords;
+    }
+
+    virtual bool addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult)
+    {
+        bool bResult = false;
+
+        if (disasmResult.bIsValid && _claim(m_pContext, disasmResult.nAddress, m_nFunction)) {
+            XDisasmAbstract::DISASM_RECORD record = XDisasmAbstract::toRecord(disasmResult);
+            m_pListRecords->append(record);
+
+            bResult = !_isBlockEnd(record);
+        }
+
+        return bResult;
+    }
+
+private:
+    CFG_CONTEXT *m_pContext;
+    XADDR m_nFunction;
+    QVector<XDisasmAbstract::DISASM_RECORD> *m_pListRecords;
+};
+
+static void _traceFunction(CFG_CONTEXT *pContext, XADDR nFunction, QVector<XDisasmAbstract::DISASM_RECORD> *pListRecords)
+{
+    XDisasmAbstract::DISASM_OPTIONS disasmOptions = {};
+    disasmOptions.bLengthOnly = true;
+
+    QList<XADDR> listBlockQueue;
+    listBlockQueue.append(nFunction);
+
+    while ((!listBlockQueue.isEmpty()) && XBinary::isPdStructNotCanceled(pContext->pPdStruct)) {
+        XADDR nAddress = listBlockQueue.takeLast();
+        char *pData = nullptr;
+        qint32 nDataSize = 0;
+
+        if (_findRegion(pContext->listRegions, nAddress, &pData, &nDataSize)) {
+            qint32 nStartIndex = pListRecords->count();
+
+            XDisasmTraceSink sink(pContext, nFunction, pListRecords);
+            pContext->pDisasmCore->disAsmStreamShared(pData, nDataSize, nAddress, disasmOptions, &sink, pContext->pPdStruct);
+
+            qint32 nNumberOfRecords = pListRecords->count();
+
+            for (qint32 i = nStartIndex; i < nNumberOfRecords; i++) {
+                const XDisasmAbstract::DISASM_RECORD &record = pListRecords->at(i);
+
+                if (record.nRelType != XDisasmAbstract::RELTYPE_NONE) {
+                    if ((record.nRelType == XDisasmAbstract::RELTYPE_CALL) || (record.nFlags & XDisasmAbstract::RECFLAG_CALL)) {
+                        _addFunction(pContext, record.nXrefTo);
+                    } else {
+                        listBlockQueue.append(record.nXrefTo);
+                    }
+                }
+
+                if (_isCondBranch(record)) {
+                    listBlockQueue.append(record.nAddress + record.nSize);
+                }
+            }
+        }
+    }
+}
+
+// Pulls functions from the shared queue until it is empty and no other worker can add more
+static void _runWorker(CFG_CONTEXT *pContext, QVector<XDisasmAbstract::DISASM_RECORD> *pListRecords)
+{
+    while (true) {
+        XADDR nFunction = 0;
+        bool bIsFound = false;
+
+        {
+            QMutexLocker locker(&pContext->mutex);
+
+            while (pContext->listFunctionQueue.isEmpty() && pContext->nNumberOfBusy && (!pContext->bIsStop)) {
+                pContext->waitCondition.wait(&pContext->mutex);
+            }
+
+            if ((!pContext->listFunctionQueue.isEmpty()) && (!pContext->bIsStop)) {
+                nFunction = pContext->listFunctionQueue.takeFirst();
+                pContext->nNumberOfBusy++;
+                bIsFound = true;
+            }
+        }
+
+        if (!bIsFound) {
+            break;
+        }
+
+        _traceFunction(pContext, nFunction, pListRecords);
+
+        {
+            QMutexLocker locker(&pContext->mutex);
+
+            pContext->nNumberOfBusy--;
+
+            if (!XBinary::isPdStructNotCanceled(pContext->pPdStruct)) {
+                pContext->bIsStop = true;
+            }
+
+            if (pContext->bIsStop || (pContext->listFunctionQueue.isEmpty() && (pContext->nNumberOfBusy == 0))) {
+                pContext->waitCondition.wakeAll();
+            }
+        }
+    }
+}
+
+class XDisasmCFGTask : public QRunnable {
+public:
+    XDisasmCFGTask(CFG_CONTEXT *pContext, QVector<XDisasmAbstract::DISASM_RECORD> *pListRecords)
+    {
+        m_pContext = pContext;
+        m_pListRecords = pListRecords;
+    }
+
+    virtual void run()
+    {
+        _runWorker(m_pContext, m_pListRecords);
+    }
+
+private:
+    CFG_CONTEXT *m_pContext;
+    QVector<XDisasmAbstract::DISASM_RECORD> *m_pListRecords;
+};
+
+XDisasmCFG::XDisasmCFG(XDisasmCore *pDisasmCore, QObject *pParent) : QObject(pParent)
+{
+    m_pDisasmCore = pDisasmCore;
+}
+
+XDisasmCFG::GRAPH XDisasmCFG::build(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, const QList<XADDR> &listEntryPoints, qint32 nNumberOfThreads,
+                                    XBinary::PDSTRUCT *pPdStruct)
+{
+    GRAPH result = {};
+
+    XDisasmCore::MAPPED_INPUT mappedInput = {};
+
+    if (XDisasmCore::mapInput(pDevice, pMemoryMap, &mappedInput)) {
+        CFG_CONTEXT context;
+        context.pDisasmCore = m_pDisasmCore;
+        context.listRegions = mappedInput.listRegions.toVector();
+        context.pPdStruct = pPdStruct;
+        context.nNumberOfBusy = 0;
+        context.bIsStop = false;
+
+        std::sort(context.listRegions.begin(), context.listRegions.end(),
+                  [](const XDisasmCore::MEMORY_REGION &a, const XDisasmCore::MEMORY_REGION &b) { return a.nAddress < b.nAddress; });
+
+        qint32 nNumberOfEntryPoints = listEntryPoints.count();
+
+        for (qint32 i = 0; i < nNumberOfEntryPoints; i++) {
+            _addFunction(&context, listEntryPoints.at(i));
+        }
+
+        if (nNumberOfThreads <= 0) {
+            nNumberOfThreads = QThread::idealThreadCount();
+        }
+
+        nNumberOfThreads = qMax(nNumberOfThreads, 1);
+
+        QVector<QVector<XDisasmAbstract::DISASM_RECORD>> listWorkerRecords(nNumberOfThreads);
+
+        if (nNumberOfThreads == 1) {
+            _runWorker(&context, &(listWorkerRecords[0]));
+        } else {
+            QThreadPool threadPool;
+            threadPool.setMaxThreadCount(nNumberOfThreads);
+
+            for (qint32 i = 0; i < nNumberOfThreads; i++) {
+                threadPool.start(new XDisasmCFGTask(&context, &(listWorkerRecords[i])));
+            }
+
+            threadPool.waitForDone();
+        }
+
+        for (qint32 i = 0; i < nNumberOfThreads; i++) {
+            result.listRecords += listWorkerRecords.at(i);
+        }
+
+        std::sort(result.listRecords.begin(), result.listRecords.end(),
+                  [](const XDisasmAbstract::DISASM_RECORD &a, const XDisasmAbstract::DISASM_RECORD &b) { return a.nAddress < b.nAddress; });
+
+        QSet<XADDR> setLeaders;
+
+        // Functions whose entry lies outside the mapped data (or does not decode) were never claimed
+        QSetIterator<XADDR> iterFunctions(context.setFunctions);
+
+        while (iterFunctions.hasNext()) {
+            XADDR nFunction = iterFunctions.next();
+            XADDR nOwner = 0;
+
+            if (_getClaim(&context, nFunction, &nOwner)) {
+                result.listFunctions.append(nFunction);
+                setLeaders.insert(nFunction);
+            }
+        }
+
+        std::sort(result.listFunctions.begin(), result.listFunctions.end());
+
+        qint32 nNumberOfRecords = result.listRecords.count();
+
+        for (qint32 i = 0; i < nNumberOfRecords; i++) {
+            const XDisasmAbstract::DISASM_RECORD &record = result.listRecords.at(i);
+
+            if (record.nRelType != XDisasmAbstract::RELTYPE_NONE) {
+                setLeaders.insert(record.nXrefTo);
+            }
+
+            if (_isCondBranch(record)) {
+                setLeaders.insert(record.nAddress + record.nSize);
+            }
+        }
+
+        qint32 nIndex = 0;
+
+        while (nIndex < nNumberOfRecords) {
+            BLOCK block = {};
+            block.nAddress = result.listRecords.at(nIndex).nAddress;
+            block.nFunction = 0;
+            _getClaim(&context, block.nAddress, &(block.nFunction));
+            block.nFirstRecord = nIndex;
+            block.nFirstEdge = result.listEdges.count();
+
+            while (true) {
+                const XDisasmAbstract::DISASM_RECORD &record = result.listRecords.at(nIndex);
+                XADDR nNextAddress = record.nAddress + record.nSize;
+
+                if ((record.nRelType != XDisasmAbstract::RELTYPE_NONE) &&
+                    ((record.nRelType == XDisasmAbstract::RELTYPE_CALL) || (record.nFlags & XDisasmAbstract::RECFLAG_CALL))) {
+                    EDGE edge = {block.nAddress, record.nXrefTo, EDGETYPE_CALL};
+                    result.listEdges.append(edge);
+                }
+
+                nIndex++;
+
+                bool bIsNext = (nIndex < nNumberOfRecords) && (result.listRecords.at(nIndex).nAddress == nNextAddress);
+
+                if (_isBlockEnd(record) || (!bIsNext) || setLeaders.contains(nNextAddress)) {
+                    if (_isCondBranch(record)) {
+                        if (record.nRelType != XDisasmAbstract::RELTYPE_NONE) {
+                            EDGE edge = {block.nAddress, record.nXrefTo, EDGETYPE_CONDJMP};
+                            result.listEdges.append(edge);
+                        }
+                    } else if (record.nFlags & XDisasmAbstract::RECFLAG_JMP) {
+                        if (record.nRelType != XDisasmAbstract::RELTYPE_NONE) {
+                            EDGE edge = {block.nAddress, record.nXrefTo, EDGETYPE_JMP};
+                            result.listEdges.append(edge);
+                        }
+                    }
+
+                    if (bIsNext && (!(record.nFlags & (XDisasmAbstract::RECFLAG_RET | XDisasmAbstract::RECFLAG_JMP)))) {
+                        EDGE edge = {block.nAddress, nNextAddress, EDGETYPE_FALLTHROUGH};
+                        result.listEdges.append(edge);
+                    }
+
+                    block.nSize = (quint32)(nNextAddress - block.nAddress);
+
+                    break;
+                }
+            }
+
+            block.nNumberOfRecords = nIndex - block.nFirstRecord;
+            block.nNumberOfEdges = result.listEdges.count() - block.nFirstEdge;
+
+            result.listBlocks.append(block);
+        }
+    }
+
+    XDisasmCore::unmapInput(&mappedInput);
+
+    return result;
+}
+
+qint32 XDisasmCFG::findBlock(const GRAPH &graph, XADDR nAddress)
+{
+    qint32 nResult = -1;
+
+    qint32 nLow = 0;
+    qint32 nHigh = graph.listBlocks.count();
+
+    while (nLow < nHigh) {
+        qint32 nMiddle = (nLow + nHigh) / 2;
+
+        if (graph.listBlocks.at(nMiddle).nAddress <= nAddress) {
+            nLow = nMiddle + 1;
+        } else {
+            nHigh = nMiddle;
+        }
+    }
+
+    if (nLow > 0) {
+        const BLOCK &block = graph.listBlocks.at(nLow - 1);
+
+        if ((nAddress - block.nAddress) < block.nSize) {
+            nResult = nLow - 1;
+        }
+    }
+
+    return nResult;
+}
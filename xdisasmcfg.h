@@ -0,0 +1,78 @@
+/* Copyright (c) 2025-2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef XDISASMCFG_H
+#define XDISASMCFG_H
+
+#include "xdisasmcore.h"
+
+#include <QSet>
+#include <QWaitCondition>
+
+// Recursive-descent control-flow graph: follows branch and call targets from entry points across the
+// file-backed records of a memory map. Every instruction start is claimed before it is decoded, so no
+// instruction is decoded twice, also when several workers trace functions concurrently.
+class XDisasmCFG : public QObject {
+    Q_OBJECT
+
+public:
+    enum EDGETYPE : quint8 {
+        EDGETYPE_FALLTHROUGH = 0,  // Sequential flow, also the not-taken side of a conditional branch
+        EDGETYPE_JMP,
+        EDGETYPE_CONDJMP,
+        EDGETYPE_CALL
+    };
+
+    struct BLOCK {
+        XADDR nAddress;
+        XADDR nFunction;  // Entry of the function that reached the block first
+        quint32 nSize;
+        qint32 nFirstRecord;  // Index into GRAPH::listRecords
+        qint32 nNumberOfRecords;
+        qint32 nFirstEdge;  // Index into GRAPH::listEdges
+        qint32 nNumberOfEdges;
+    };
+
+    struct EDGE {
+        XADDR nFrom;  // Block address
+        XADDR nTo;
+        EDGETYPE edgeType;
+    };
+
+    struct GRAPH {
+        QVector<XDisasmAbstract::DISASM_RECORD> listRecords;  // Sorted by address
+        QVector<BLOCK> listBlocks;                            // Sorted by address
+        QVector<EDGE> listEdges;                              // Grouped by block
+        QVector<XADDR> listFunctions;                         // Sorted by address
+    };
+
+    explicit XDisasmCFG(XDisasmCore *pDisasmCore, QObject *pParent = nullptr);
+
+    // nNumberOfThreads: 1 traces on the calling thread, 0 uses QThread::idealThreadCount workers that pull functions from a shared queue
+    GRAPH build(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, const QList<XADDR> &listEntryPoints, qint32 nNumberOfThreads = 1,
+                XBinary::PDSTRUCT *pPdStruct = 0);
+    static qint32 findBlock(const GRAPH &graph, XADDR nAddress);  // Block containing nAddress, -1 if none
+
+private:
+    XDisasmCore *m_pDisasmCore;
+};
+
+#endif  // XDISASMCFG_H
@@ -0,0 +1,284 @@
+/* Copyright (c) 2025-2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "xdisasmcheckpoints.h"
+
+#include <algorithm>
+
+const quint32 N_CHECKPOINTS_MAGIC = 0x50434458;  // "XDCP"
+const quint32 N_CHECKPOINTS_VERSION = 1;
+const qint64 N_CHECKPOINTS_WINDOW = 0x40000000;  // _disasm takes a qint32 size
+
+// Stops at the first instruction that starts at or after nTarget and remembers the one before it
+class XDisasmSeekSink : public XDisasmSink {
+public:
+    explicit XDisasmSeekSink(XADDR nTarget)
+    {
+        m_nTarget = nTarget;
+        m_nPrev = 0;
+        m_nNext = 0;
+        m_bIsPrev = false;
+        m_bIsNext = false;
+    }
+
+    virtual bool addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult)
+    {
+        bool bResult = true;
+
+        if (disasmResult.nAddress >= m_nTarget) {
+            m_nNext = disasmResult.nAddress;
+            m_bIsNext = true;
+            bResult = false;
+        } else {
+            m_nPrev = disasmResult.nAddress;
+            m_bIsPrev = true;
+        }
+
+        return bResult;
+    }
+
+    XADDR m_nTarget;
+    XADDR m_nPrev;
+    XADDR m_nNext;
+    bool m_bIsPrev;
+    bool m_bIsNext;
+};
+
+XDisasmCheckpoints::XDisasmCheckpoints(qint32 nInterval, QObject *pParent) : QObject(pParent)
+{
+    m_nInterval = qMax(nInterval, 1);
+    m_nCounter = 0;
+    m_bSweepVerified = false;
+}
+
+void XDisasmCheckpoints::clear()
+{
+    m_listCheckpoints.clear();
+    m_nCounter = 0;
+    m_bSweepVerified = false;
+}
+
+void XDisasmCheckpoints::setInterval(qint32 nInterval)
+{
+    m_nInterval = qMax(nInterval, 1);
+}
+
+qint32 XDisasmCheckpoints::getInterval() const
+{
+    return m_nInterval;
+}
+
+qint32 XDisasmCheckpoints::getNumberOfCheckpoints() const
+{
+    return m_listCheckpoints.count();
+}
+
+const QVector<XADDR> &XDisasmCheckpoints::getCheckpoints() const
+{
+    return m_listCheckpoints;
+}
+
+bool XDisasmCheckpoints::beginSweep(XADDR nAddress)
+{
+    // A sweep from an arbitrary address (e.g. the middle of an instruction) would store misaligned starts
+    m_nCounter = 0;
+    m_bSweepVerified = isCheckpoint(nAddress);
+
+    return m_bSweepVerified;
+}
+
+void XDisasmCheckpoints::addInstruction(XADDR nAddress)
+{
+    if (m_bSweepVerified) {
+        // Sweeps that start at the same address keep the same checkpoints, so repeated scrolling does not grow the index
+        if ((m_nCounter % m_nInterval) == 0) {
+            addCheckpoint(nAddress);
+        }
+
+        m_nCounter++;
+    }
+}
+
+bool XDisasmCheckpoints::isCheckpoint(XADDR nAddress) const
+{
+    return std::binary_search(m_listCheckpoints.constBegin(), m_listCheckpoints.constEnd(), nAddress);
+}
+
+void XDisasmCheckpoints::addCheckpoint(XADDR nAddress)
+{
+    QVector<XADDR>::iterator iter = std::lower_bound(m_listCheckpoints.begin(), m_listCheckpoints.end(), nAddress);
+
+    if ((iter == m_listCheckpoints.end()) || (*iter != nAddress)) {
+        m_listCheckpoints.insert(iter, nAddress);
+    }
+}
+
+void XDisasmCheckpoints::removeCheckpoints(XADDR nStart, XADDR nEnd)
+{
+    if (nStart < nEnd) {
+        QVector<XADDR>::iterator iterStart = std::lower_bound(m_listCheckpoints.begin(), m_listCheckpoints.end(), nStart);
+        QVector<XADDR>::iterator iterEnd = std::lower_bound(iterStart, m_listCheckpoints.end(), nEnd);
+
+        m_listCheckpoints.erase(iterStart, iterEnd);
+    }
+}
+
+bool XDisasmCheckpoints::findCheckpoint(XADDR nAddress, XADDR *pnCheckpoint) const
+{
+    bool bResult = false;
+
+    QVector<XADDR>::const_iterator iter = std::upper_bound(m_listCheckpoints.constBegin(), m_listCheckpoints.constEnd(), nAddress);
+
+    if (iter != m_listCheckpoints.constBegin()) {
+        *pnCheckpoint = *(iter - 1);
+        bResult = true;
+    }
+
+    return bResult;
+}
+
+bool XDisasmCheckpoints::_seek(const XDisasmCore *pDisasmCore, const XDisasmCore::MEMORY_REGION &region, XADDR nAddress, XADDR *pnPrev, XADDR *pnNext) const
+{
+    bool bResult = false;
+
+    if ((nAddress >= region.nAddress) && ((qint64)(nAddress - region.nAddress) <= region.nSize)) {
+        XADDR nStart = region.nAddress;
+        XADDR nCheckpoint = 0;
+
+        // Strictly below nAddress, so the instruction before a checkpoint is found too
+        if ((nAddress > region.nAddress) && findCheckpoint(nAddress - 1, &nCheckpoint) && (nCheckpoint >= region.nAddress)) {
+            nStart = nCheckpoint;
+        }
+
+        qint64 nDelta = (qint64)(nStart - region.nAddress);
+        qint32 nDataSize = (qint32)qMin(region.nSize - nDelta, N_CHECKPOINTS_WINDOW);
+
+        XDisasmAbstract::DISASM_OPTIONS disasmOptions = {};
+        disasmOptions.bLengthOnly = true;
+        disasmOptions.bNoXrefs = true;
+
+        XDisasmSeekSink sink(nAddress);
+        pDisasmCore->disAsmStreamShared(region.pData + nDelta, nDataSize, nStart, disasmOptions, &sink);
+
+        if (pnPrev && sink.m_bIsPrev) {
+            *pnPrev = sink.m_nPrev;
+            bResult = true;
+        }
+
+        if (pnNext && sink.m_bIsNext) {
+            *pnNext = sink.m_nNext;
+            bResult = true;
+        }
+    }
+
+    return bResult;
+}
+
+bool XDisasmCheckpoints::getPrevInstruction(const XDisasmCore *pDisasmCore, const XDisasmCore::MEMORY_REGION &region, XADDR nAddress, XADDR *pnResult) const
+{
+    return _seek(pDisasmCore, region, nAddress, pnResult, nullptr);
+}
+
+bool XDisasmCheckpoints::getNextInstruction(const XDisasmCore *pDisasmCore, const XDisasmCore::MEMORY_REGION &region, XADDR nAddress, XADDR *pnResult) const
+{
+    return _seek(pDisasmCore, region, nAddress, nullptr, pnResult);
+}
+
+bool XDisasmCheckpoints::save(QIODevice *pDevice) const
+{
+    QDataStream stream(pDevice);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    stream << N_CHECKPOINTS_MAGIC;
+    stream << N_CHECKPOINTS_VERSION;
+    qint32 nNumberOfCheckpoints = m_listCheckpoints.count();
+
+    stream << (qint32)m_nInterval;
+    stream << nNumberOfCheckpoints;
+
+    for (qint32 i = 0; i < nNumberOfCheckpoints; i++) {
+        stream << (quint64)m_listCheckpoints.at(i);
+    }
+
+    return (stream.status() == QDataStream::Ok);
+}
+
+bool XDisasmCheckpoints::load(QIODevice *pDevice)
+{
+    bool bResult = false;
+
+    QDataStream stream(pDevice);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 nMagic = 0;
+    quint32 nVersion = 0;
+    qint32 nInterval = 0;
+    qint32 nNumberOfCheckpoints = 0;
+
+    stream >> nMagic;
+    stream >> nVersion;
+    stream >> nInterval;
+    stream >> nNumberOfCheckpoints;
+
+    if ((stream.status() == QDataStream::Ok) && (nMagic == N_CHECKPOINTS_MAGIC) && (nVersion == N_CHECKPOINTS_VERSION) && (nNumberOfCheckpoints >= 0)) {
+        QVector<XADDR> listCheckpoints;
+        listCheckpoints.reserve(qMin(nNumberOfCheckpoints, 0x100000));
+
+        for (qint32 i = 0; (i < nNumberOfCheckpoints) && (stream.status() == QDataStream::Ok); i++) {
+            quint64 nAddress = 0;
+            stream >> nAddress;
+            listCheckpoints.append((XADDR)nAddress);
+        }
+
+        if ((stream.status() == QDataStream::Ok) && std::is_sorted(listCheckpoints.constBegin(), listCheckpoints.constEnd())) {
+            m_nInterval = qMax(nInterval, 1);
+            m_nCounter = 0;
+            m_bSweepVerified = false;
+            m_listCheckpoints = listCheckpoints;
+            bResult = true;
+        }
+    }
+
+    return bResult;
+}
+
+XDisasmCheckpointSink::XDisasmCheckpointSink(XDisasmCheckpoints *pCheckpoints, XADDR nAddress, XDisasmSink *pTarget)
+{
+    m_pCheckpoints = pCheckpoints;
+    m_pTarget = pTarget;
+
+    m_pCheckpoints->beginSweep(nAddress);
+}
+
+bool XDisasmCheckpointSink::addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult)
+{
+    bool bResult = true;
+
+    if (disasmResult.bIsValid) {
+        m_pCheckpoints->addInstruction(disasmResult.nAddress);
+    }
+
+    if (m_pTarget) {
+        bResult = m_pTarget->addDisasmResult(disasmResult);
+    }
+
+    return bResult;
+}
@@ -0,0 +1,80 @@
+/* Copyright (c) 2025-2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef XDISASMCHECKPOINTS_H
+#define XDISASMCHECKPOINTS_H
+
+#include "xdisasmcore.h"
+
+#include <QDataStream>
+
+// Sparse index of instruction starts seen by linear sweeps: every Nth start of a sweep is kept. The previous
+// instruction before an address, or the first one at or after it, is then found by decoding forward from the
+// nearest checkpoint of the same region, which is at most about N instructions away. Only sweeps that start at an
+// existing checkpoint are recorded, so the owner seeds the index with known starts (entry points, region starts).
+class XDisasmCheckpoints : public QObject {
+    Q_OBJECT
+
+public:
+    explicit XDisasmCheckpoints(qint32 nInterval = 64, QObject *pParent = nullptr);
+
+    void clear();
+    void setInterval(qint32 nInterval);
+    qint32 getInterval() const;
+    qint32 getNumberOfCheckpoints() const;
+    const QVector<XADDR> &getCheckpoints() const;
+
+    bool beginSweep(XADDR nAddress);      // false (and the sweep is ignored) if nAddress is not a checkpoint
+    void addInstruction(XADDR nAddress);  // Every valid start of the sweep, in order
+    bool isCheckpoint(XADDR nAddress) const;
+    void addCheckpoint(XADDR nAddress);
+    void removeCheckpoints(XADDR nStart, XADDR nEnd);  // [nStart, nEnd), e.g. after the bytes there changed
+    bool findCheckpoint(XADDR nAddress, XADDR *pnCheckpoint) const;  // Last checkpoint <= nAddress
+
+    // Bounded decodes from the nearest checkpoint inside region (or the region start)
+    bool getPrevInstruction(const XDisasmCore *pDisasmCore, const XDisasmCore::MEMORY_REGION &region, XADDR nAddress, XADDR *pnResult) const;
+    bool getNextInstruction(const XDisasmCore *pDisasmCore, const XDisasmCore::MEMORY_REGION &region, XADDR nAddress, XADDR *pnResult) const;
+
+    bool save(QIODevice *pDevice) const;
+    bool load(QIODevice *pDevice);
+
+private:
+    bool _seek(const XDisasmCore *pDisasmCore, const XDisasmCore::MEMORY_REGION &region, XADDR nAddress, XADDR *pnPrev, XADDR *pnNext) const;
+
+    qint32 m_nInterval;
+    qint32 m_nCounter;
+    bool m_bSweepVerified;
+    QVector<XADDR> m_listCheckpoints;  // Sorted
+};
+
+// Feeds the valid results of one sweep into the index and forwards them to pTarget, if any
+class XDisasmCheckpointSink : public XDisasmSink {
+public:
+    XDisasmCheckpointSink(XDisasmCheckpoints *pCheckpoints, XADDR nAddress, XDisasmSink *pTarget = nullptr);  // nAddress: start of the sweep
+
+    virtual bool addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult);
+
+private:
+    XDisasmCheckpoints *m_pCheckpoints;
+    XDisasmSink *m_pTarget;
+};
+
+#endif  // XDISASMCHECKPOINTS_H
@@ -20,6 +20,18 @@ set(XDISASMCORE_SOURCES
     ${CMAKE_CURRENT_LIST_DIR}/Modules/xmacho_commands.h
     ${CMAKE_CURRENT_LIST_DIR}/xdisasmcore.cpp
     ${CMAKE_CURRENT_LIST_DIR}/xdisasmcore.h
+    ${CMAKE_CURRENT_LIST_DIR}/xdisasmcfg.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/xdisasmcfg.h
+    ${CMAKE_CURRENT_LIST_DIR}/xdisasmxrefindex.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/xdisasmxrefindex.h
+    ${CMAKE_CURRENT_LIST_DIR}/xdisasmcheckpoints.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/xdisasmcheckpoints.h
+    ${CMAKE_CURRENT_LIST_DIR}/xdisasmdatabase.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/xdisasmdatabase.h
+    ${CMAKE_CURRENT_LIST_DIR}/xsignaturescanner.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/xsignaturescanner.h
     ${CMAKE_CURRENT_LIST_DIR}/xdisasmabstract.cpp
     ${CMAKE_CURRENT_LIST_DIR}/xdisasmabstract.h
+    ${CMAKE_CURRENT_LIST_DIR}/xmemorymapindex.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/xmemorymapindex.h
 )
@@ -21,14 +21,327 @@
 
 #include "xdisasmcore.h"
 
+#include "xdisasmcheckpoints.h"
+
+#include <algorithm>
+
+const qint64 N_READCACHE_BLOCK_SIZE = 0x10000;  // Must be a power of two
+const qint32 N_READCACHE_PADDING = 16;
+const qint64 N_REGION_CHUNK_SIZE = 0x40000000;  // _disasm takes a qint32 size
+const qint64 N_REGION_CHUNK_OVERLAP = 0x100;    // Longer than any instruction
+const qint64 N_PARALLEL_MIN_CHUNK_SIZE = 0x10000;
+const qint32 N_SIGNATURE_BUFFER_SIZE = 32;  // Longest instruction plus the read cache padding
+const qint32 N_OG_COUNT = XDisasmCore::OG_OPCODE_SYSCALL + 1;
+
+// Forwards results that start below nBoundary and remembers where the next one starts, so a
+// sweep split into windows can resume exactly at the first instruction the window did not emit.
+class XDisasmBoundarySink : public XDisasmSink {
+public:
+    XDisasmBoundarySink(XDisasmSink *pTarget, XADDR nBoundary)
+    {
+        m_pTarget = pTarget;
+        m_nBoundary = nBoundary;
+        m_nNextAddress = 0;
+        m_bIsTargetStop = false;
+        m_bIsBoundary = false;
+    }
+
+    virtual bool addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult)
+    {
+        if (disasmResult.nAddress >= m_nBoundary) {
+            m_bIsBoundary = true;
+            return false;
+        }
+
+        m_nNextAddress = disasmResult.nAddress + disasmResult.nSize;
+
+        if (!m_pTarget->addDisasmResult(disasmResult)) {
+            m_bIsTargetStop = true;
+        }
+
+        return !m_bIsTargetStop;
+    }
+
+    XDisasmSink *m_pTarget;
+    XADDR m_nBoundary;
+    XADDR m_nNextAddress;
+    bool m_bIsTargetStop;
+    bool m_bIsBoundary;
+};
+
+struct SWEEP_CHUNK {
+    char *pData;
+    qint32 nWindowSize;
+    XADDR nAddress;
+    XADDR nBoundary;
+    QVector<XDisasmAbstract::DISASM_RECORD> listRecords;
+    XADDR nNextAddress;
+    bool bIsBoundary;
+};
+
+static qint32 _findRecord(const QVector<XDisasmAbstract::DISASM_RECORD> &listRecords, qint32 nStartIndex, XADDR nAddress)
+{
+    qint32 nLeft = nStartIndex;
+    qint32 nRight = listRecords.count() - 1;
+
+    while (nLeft <= nRight) {
+        qint32 nMiddle = nLeft + (nRight - nLeft) / 2;
+        XADDR nCurrent = listRecords.at(nMiddle).nAddress;
+
+        if (nCurrent == nAddress) {
+            return nMiddle;
+        } else if (nCurrent < nAddress) {
+            nLeft = nMiddle + 1;
+        } else {
+            nRight = nMiddle - 1;
+        }
+    }
+
+    return -1;
+}
+
+// Decodes one chunk of a parallel sweep speculatively from the chunk start on a pooled backend.
+class XDisasmChunkTask : public QRunnable {
+public:
+    XDisasmChunkTask(const XDisasmCore *pDisasmCore, SWEEP_CHUNK *pChunk, XBinary::PDSTRUCT *pPdStruct)
+    {
+        m_pDisasmCore = pDisasmCore;
+        m_pChunk = pChunk;
+        m_pPdStruct = pPdStruct;
+    }
+
+    virtual void run()
+    {
+        XDisasmAbstract::DISASM_OPTIONS disasmOptions = {};
+        disasmOptions.bLengthOnly = true;
+
+        XDisasmRecordSink recordSink;
+        XDisasmBoundarySink sink(&recordSink, m_pChunk->nBoundary);
+
+        m_pDisasmCore->disAsmStreamShared(m_pChunk->pData, m_pChunk->nWindowSize, m_pChunk->nAddress, disasmOptions, &sink, m_pPdStruct);
+
+        m_pChunk->listRecords = recordSink.getRecords();
+        m_pChunk->nNextAddress = sink.m_nNextAddress;
+        m_pChunk->bIsBoundary = sink.m_bIsBoundary;
+    }
+
+private:
+    const XDisasmCore *m_pDisasmCore;
+    SWEEP_CHUNK *m_pChunk;
+    XBinary::PDSTRUCT *m_pPdStruct;
+};
+
+// Sequential re-decode from the true stream position until it meets an instruction start of the speculative chunk decode.
+class XDisasmResyncSink : public XDisasmSink {
+public:
+    XDisasmResyncSink(const QVector<XDisasmAbstract::DISASM_RECORD> *pListSpeculative, XADDR nAddress, XADDR nBoundary,
+                      QVector<XDisasmAbstract::DISASM_RECORD> *pListResult)
+    {
+        m_pListSpeculative = pListSpeculative;
+        m_nBoundary = nBoundary;
+        m_pListResult = pListResult;
+        m_nSyncIndex = -1;
+        m_nNextAddress = nAddress;
+        m_bIsBoundary = false;
+    }
+
+    virtual bool addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult)
+    {
+        if (disasmResult.nAddress >= m_nBoundary) {
+            m_bIsBoundary = true;
+            return false;
+        }
+
+        m_nSyncIndex = _findRecord(*m_pListSpeculative, 0, disasmResult.nAddress);
+
+        if (m_nSyncIndex != -1) {
+            return false;
+        }
+
+        m_pListResult->append(XDisasmAbstract::toRecord(disasmResult));
+        m_nNextAddress = disasmResult.nAddress + disasmResult.nSize;
+
+        return true;
+    }
+
+    const QVector<XDisasmAbstract::DISASM_RECORD> *m_pListSpeculative;
+    XADDR m_nBoundary;
+    QVector<XDisasmAbstract::DISASM_RECORD> *m_pListResult;
+    qint32 m_nSyncIndex;
+    XADDR m_nNextAddress;
+    bool m_bIsBoundary;
+};
+
+// Re-decodes after a patch until an instruction past the patched bytes starts where an old one started;
+// from there on the old stream is valid again.
+class XDisasmRealignSink : public XDisasmSink {
+public:
+    XDisasmRealignSink(const QVector<XDisasmAbstract::DISASM_RECORD> *pListOld, qint32 nOldIndex, XADDR nPatchEnd,
+                       QVector<XDisasmAbstract::DISASM_RECORD> *pListNew)
+    {
+        m_pListOld = pListOld;
+        m_nOldIndex = nOldIndex;
+        m_nPatchEnd = nPatchEnd;
+        m_pListNew = pListNew;
+        m_bIsRealigned = false;
+    }
+
+    virtual bool addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult)
+    {
+        qint32 nNumberOfOld = m_pListOld->count();
+
+        while ((m_nOldIndex < nNumberOfOld) && (m_pListOld->at(m_nOldIndex).nAddress < disasmResult.nAddress)) {
+            m_nOldIndex++;
+        }
+
+        if ((disasmResult.nAddress >= m_nPatchEnd) && (m_nOldIndex < nNumberOfOld) && (m_pListOld->at(m_nOldIndex).nAddress == disasmResult.nAddress)) {
+            m_bIsRealigned = true;
+            return false;
+        }
+
+        m_pListNew->append(XDisasmAbstract::toRecord(disasmResult));
+
+        return true;
+    }
+
+    const QVector<XDisasmAbstract::DISASM_RECORD> *m_pListOld;
+    qint32 m_nOldIndex;
+    XADDR m_nPatchEnd;
+    QVector<XDisasmAbstract::DISASM_RECORD> *m_pListNew;
+    bool m_bIsRealigned;
+};
+
+// Keeps the first result by value; single decodes through it allocate nothing in length-only mode
+class XDisasmFirstSink : public XDisasmSink {
+public:
+    XDisasmFirstSink()
+    {
+        m_disasmResult = {};
+    }
+
+    virtual bool addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult)
+    {
+        m_disasmResult = disasmResult;
+
+        return false;
+    }
+
+    XDisasmAbstract::DISASM_RESULT m_disasmResult;
+};
+
+// Clears a field of the instruction that starts at nStart in the pattern; returns the clipped size
+static qint32 _setWild(XDisasmCore::SIGNATURE *pSignature, qint32 nStart, qint32 nOffset, qint32 nSize)
+{
+    qint32 nPosition = nStart + nOffset;
+    qint32 nLength = qMin(nSize, pSignature->baPattern.size() - nPosition);
+
+    if ((nPosition >= nStart) && (nLength > 0)) {
+        memset(pSignature->baPattern.data() + nPosition, 0, nLength);
+        memset(pSignature->baMask.data() + nPosition, 0, nLength);
+    }
+
+    return nLength;
+}
+
+static qint32 _hexDigitValue(char cChar)
+{
+    qint32 nResult = -1;
+
+    if ((cChar >= '0') && (cChar <= '9')) {
+        nResult = cChar - '0';
+    } else if ((cChar >= 'a') && (cChar <= 'f')) {
+        nResult = cChar - 'a' + 10;
+    } else if ((cChar >= 'A') && (cChar <= 'F')) {
+        nResult = cChar - 'A' + 10;
+    }
+
+    return nResult;
+}
+
+static void _setRel(XDisasmCore::SIGNATURE *pSignature, qint32 nStart, qint32 nOffset, qint32 nSize)
+{
+    qint32 nLength = _setWild(pSignature, nStart, nOffset, nSize);
+
+    if (nLength > 0) {
+        XDisasmCore::SIGNATURE_REL rel = {};
+        rel.nOffset = nStart + nOffset;
+        rel.nSize = nLength;
+
+        pSignature->listRels.append(rel);
+    }
+}
+
+// Pulls entry offsets from a shared counter; every result goes to the slot of its input index
+class XSignatureBatchTask : public QRunnable {
+public:
+    XSignatureBatchTask(XDisasmCore *pDisasmCore, const XDisasmCore::MAPPED_INPUT *pMappedInput, XBinary::_MEMORY_MAP *pMemoryMap,
+                        QSharedPointer<const XMemoryMapIndex> pMemoryMapIndex, const QList<qint64> *pListOffsets, qint32 nCount, XDisasmCore::ST signatureType, QAtomicInt *pnNext, QAtomicInt *pnDone,
+                        QVector<QList<XDisasmCore::SIGNATURE_RECORD>> *pListResults, XBinary::PDSTRUCT *pPdStruct)
+    {
+        m_pDisasmCore = pDisasmCore;
+        m_pMappedInput = pMappedInput;
+        m_pMemoryMap = pMemoryMap;
+        m_pMemoryMapIndex = pMemoryMapIndex;
+        m_pListOffsets = pListOffsets;
+        m_nCount = nCount;
+        m_signatureType = signatureType;
+        m_pnNext = pnNext;
+        m_pnDone = pnDone;
+        m_pListResults = pListResults;
+        m_pPdStruct = pPdStruct;
+    }
+
+    virtual void run()
+    {
+        qint32 nNumberOfOffsets = m_pListOffsets->count();
+
+        while (XBinary::isPdStructNotCanceled(m_pPdStruct)) {
+            qint32 nIndex = m_pnNext->fetchAndAddRelaxed(1);
+
+            if (nIndex >= nNumberOfOffsets) {
+                break;
+            }
+
+            (*m_pListResults)[nIndex] =
+                m_pDisasmCore->_getSignatureRecords(nullptr, m_pMappedInput, m_pMemoryMap, m_pListOffsets->at(nIndex), m_nCount, m_signatureType, m_pMemoryMapIndex);
+
+            m_pnDone->fetchAndAddRelease(1);
+        }
+    }
+
+private:
+    XDisasmCore *m_pDisasmCore;
+    const XDisasmCore::MAPPED_INPUT *m_pMappedInput;
+    XBinary::_MEMORY_MAP *m_pMemoryMap;
+    QSharedPointer<const XMemoryMapIndex> m_pMemoryMapIndex;
+    const QList<qint64> *m_pListOffsets;
+    qint32 m_nCount;
+    XDisasmCore::ST m_signatureType;
+    QAtomicInt *m_pnNext;
+    QAtomicInt *m_pnDone;
+    QVector<QList<XDisasmCore::SIGNATURE_RECORD>> *m_pListResults;
+    XBinary::PDSTRUCT *m_pPdStruct;
+};
+
 XDisasmCore::XDisasmCore(QObject *pParent) : QObject(pParent)
 {
     m_disasmMode = XBinary::DM_UNKNOWN;
     m_disasmFamily = XBinary::DMFAMILY_UNKNOWN;
+    m_opcodeClassTable = XDisasmAbstract::getOpcodeClassTable(m_disasmFamily);
     m_pDisasmAbstract = nullptr;
+    m_pCheckpoints = nullptr;
     m_nOpcodeSize = 15;
     m_syntax = XBinary::SYNTAX_DEFAULT;
     m_pOptions = nullptr;
+    m_nReadCacheOffset = 0;
+    m_nReadCacheSize = 0;
+    m_bReadCacheEnd = false;
+    m_decodeCache.setMaxCost(0);
+    m_nDecodeCacheHits = 0;
+    m_nDecodeCacheMisses = 0;
+    m_renderCache.setMaxCost(0);
+    m_listColors.resize(N_OG_COUNT);
+    m_nColorGeneration = 0;
 #ifdef QT_GUI_LIB
     m_qTextOptions.setWrapMode(QTextOption::NoWrap);
 #endif
@@ -40,6 +353,8 @@ XDisasmCore::~XDisasmCore()
         delete m_pDisasmAbstract;
         // XCapstone::closeHandle(&m_handle);
     }
+
+    qDeleteAll(m_mapPool);
 }
 
 void XDisasmCore::setMode(XBinary::DM disasmMode)
@@ -50,23 +365,41 @@ void XDisasmCore::setMode(XBinary::DM disasmMode)
             m_pDisasmAbstract = nullptr;
         }
 
-        if (XCapstone::isModeValid(disasmMode)) {
-            m_pDisasmAbstract = new Capstone_Bridge(disasmMode, m_syntax);
-        } else if (disasmMode == XBinary::DM_CUSTOM_7ZIP_PROPERTIES) {
-            m_pDisasmAbstract = new X7Zip_Properties();
-        } else if ((disasmMode == XBinary::DM_CUSTOM_MACH_BIND) || (disasmMode == XBinary::DM_CUSTOM_MACH_WEAK) || (disasmMode == XBinary::DM_CUSTOM_MACH_EXPORT) ||
-                   (disasmMode == XBinary::DM_CUSTOM_MACH_REBASE)) {
-            m_pDisasmAbstract = new XMachO_Commands(disasmMode);
-        }
+        m_pDisasmAbstract = createDisasmAbstract(disasmMode, m_syntax);
 
         m_disasmMode = disasmMode;
         m_disasmFamily = XBinary::getDisasmFamily(disasmMode);
+        m_opcodeClassTable = XDisasmAbstract::getOpcodeClassTable(m_disasmFamily);
+
+        clearDecodeCache();
+        _trimPool();
+
+        // Instruction starts of the old mode (or syntax, via setSyntax) mean nothing now; the owner seeds the index again
+        if (m_pCheckpoints) {
+            m_pCheckpoints->clear();
+        }
 
         // Keep the color map consistent with the active mode regardless of setMode/setOptions call order.
         rebuildColors();
     }
 }
 
+XDisasmAbstract *XDisasmCore::createDisasmAbstract(XBinary::DM disasmMode, XBinary::SYNTAX syntax)
+{
+    XDisasmAbstract *pResult = nullptr;
+
+    if (XCapstone::isModeValid(disasmMode)) {
+        pResult = new Capstone_Bridge(disasmMode, syntax);
+    } else if (disasmMode == XBinary::DM_CUSTOM_7ZIP_PROPERTIES) {
+        pResult = new X7Zip_Properties();
+    } else if ((disasmMode == XBinary::DM_CUSTOM_MACH_BIND) || (disasmMode == XBinary::DM_CUSTOM_MACH_WEAK) || (disasmMode == XBinary::DM_CUSTOM_MACH_EXPORT) ||
+               (disasmMode == XBinary::DM_CUSTOM_MACH_REBASE)) {
+        pResult = new XMachO_Commands(disasmMode);
+    }
+
+    return pResult;
+}
+
 void XDisasmCore::setSyntax(XBinary::SYNTAX syntax)
 {
     if (m_syntax != syntax) {
@@ -82,63 +415,208 @@ void XDisasmCore::setOptions(XOptions *pOptions)
     m_pOptions = pOptions;
     setSyntax(XBinary::stringToSyntaxId(pOptions->getValue(XOptions::ID_DISASM_SYNTAX).toString()));
 
+    clearDecodeCache();
     rebuildColors();
 }
 
 void XDisasmCore::rebuildColors()
 {
+    // Cached color strings of older generations are misses from now on
+    m_nColorGeneration++;
+
     if (m_pOptions) {
-        m_mapColors = getColorRecordsMap(m_pOptions, m_disasmMode);
+        // Flat table indexed by OG; colors are parsed here once instead of on every draw
+        QVector<COLOR_ENTRY> listColors(N_OG_COUNT);
+        QMap<OG, XOptions::COLOR_RECORD> mapColors = getColorRecordsMap(m_pOptions, m_disasmMode);
+        QMapIterator<OG, XOptions::COLOR_RECORD> iter(mapColors);
+
+        while (iter.hasNext()) {
+            iter.next();
+
+            COLOR_ENTRY &entry = listColors[iter.key()];
+            entry.colorRecord = iter.value();
+            entry.bIsSet = (!entry.colorRecord.sColorMain.isEmpty()) || (!entry.colorRecord.sColorBackground.isEmpty());
+#ifdef QT_GUI_LIB
+            if (!entry.colorRecord.sColorMain.isEmpty()) {
+                entry.colorMain = XOptions::stringToColor(entry.colorRecord.sColorMain);
+            }
+
+            if (!entry.colorRecord.sColorBackground.isEmpty()) {
+                entry.colorBackground = XOptions::stringToColor(entry.colorRecord.sColorBackground);
+            }
+#endif
+        }
+
+        m_listColors = listColors;
+    }
+}
+
+XDisasmAbstract *XDisasmCore::_acquireDisasmAbstract(quint64 *pnKey) const
+{
+    XDisasmAbstract *pResult = nullptr;
+
+    *pnKey = _getPoolKey();
+
+    {
+        QMutexLocker locker(&m_mutexPool);
+
+        QMultiHash<quint64, XDisasmAbstract *>::iterator iter = m_mapPool.find(*pnKey);
+
+        if (iter != m_mapPool.end()) {
+            pResult = iter.value();
+            m_mapPool.erase(iter);
+        }
+    }
+
+    // Opening a handle is the expensive part; do it outside the lock
+    if (!pResult) {
+        pResult = createDisasmAbstract(m_disasmMode, m_syntax);
+    }
+
+    return pResult;
+}
+
+void XDisasmCore::_releaseDisasmAbstract(XDisasmAbstract *pDisasmAbstract, quint64 nKey) const
+{
+    if (pDisasmAbstract) {
+        if (nKey == _getPoolKey()) {
+            QMutexLocker locker(&m_mutexPool);
+
+            m_mapPool.insert(nKey, pDisasmAbstract);
+        } else {
+            // Checked out before a mode change; nothing would ever take it again
+            delete pDisasmAbstract;
+        }
+    }
+}
+
+quint64 XDisasmCore::_getPoolKey() const
+{
+    return (((quint64)m_disasmMode) << 32) | ((quint64)m_syntax);
+}
+
+void XDisasmCore::_trimPool()
+{
+    quint64 nKey = _getPoolKey();
+    QList<XDisasmAbstract *> listRemoved;
+
+    {
+        QMutexLocker locker(&m_mutexPool);
+
+        QMultiHash<quint64, XDisasmAbstract *>::iterator iter = m_mapPool.begin();
+
+        while (iter != m_mapPool.end()) {
+            if (iter.key() != nKey) {
+                listRemoved.append(iter.value());
+                iter = m_mapPool.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+
+    // Closing the handles outside the lock
+    qDeleteAll(listRemoved);
+}
+
+XDisasmAbstract::DISASM_RESULT XDisasmCore::disAsmShared(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions) const
+{
+    XDisasmAbstract::DISASM_RESULT result = {};
+
+    XDisasmListSink sink(1);
+
+    disAsmStreamShared(pData, nDataSize, nAddress, disasmOptions, &sink, nullptr);
+
+    QList<XDisasmAbstract::DISASM_RESULT> listResults = sink.getResults();
+
+    if (listResults.count()) {
+        result = listResults.at(0);
+    }
+
+    return result;
+}
+
+void XDisasmCore::disAsmStreamShared(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink,
+                                     XBinary::PDSTRUCT *pPdStruct) const
+{
+    quint64 nKey = 0;
+    XDisasmAbstract *pDisasmAbstract = _acquireDisasmAbstract(&nKey);
+
+    if (pDisasmAbstract) {
+        pDisasmAbstract->_disasm(pData, nDataSize, nAddress, disasmOptions, pSink, pPdStruct);
+
+        _releaseDisasmAbstract(pDisasmAbstract, nKey);
     }
 }
 
-XBinary::DMFAMILY XDisasmCore::getDisasmFamily()
+XBinary::DMFAMILY XDisasmCore::getDisasmFamily() const
 {
     return m_disasmFamily;
 }
 
-XBinary::DM XDisasmCore::getDisasmMode()
+XBinary::DM XDisasmCore::getDisasmMode() const
 {
     return m_disasmMode;
 }
 
-XBinary::SYNTAX XDisasmCore::getSyntax()
+XBinary::SYNTAX XDisasmCore::getSyntax() const
 {
     return m_syntax;
 }
 
 QString XDisasmCore::getSignature(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, XADDR nAddress, ST signatureType, qint32 nCount)
 {
-    QString sResult;
+    return signatureToString(getSignatureData(pDevice, pMemoryMap, nAddress, signatureType, nCount));
+}
+
+XDisasmCore::SIGNATURE XDisasmCore::getSignatureData(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, XADDR nAddress, ST signatureType, qint32 nCount,
+                                                    QVector<qint32> *pListInstructionOffsets)
+{
+    SIGNATURE result;
+    result.baPattern.reserve(qMax(nCount, 0) * m_nOpcodeSize);
+    result.baMask.reserve(qMax(nCount, 0) * m_nOpcodeSize);
 
+    // Only sizes, encoding offsets and branch targets are used here; skip the mnemonic/operand text.
     XDisasmAbstract::DISASM_OPTIONS disasmOptions = {};
+    disasmOptions.bLengthOnly = true;
 
-    while (nCount > 0) {
-        qint64 nOffset = XBinary::addressToOffset(pMemoryMap, nAddress);
+    QSharedPointer<const XMemoryMapIndex> pMemoryMapIndex = _getMemoryMapIndex(pMemoryMap);
+    XMemoryMapIndex::CURSOR cursor = XMemoryMapIndex::getCursor();
+
+    // Bytes come from the read cache, so consecutive instructions share one bulk read
+    while ((nCount > 0) && m_pDisasmAbstract) {
+        qint64 nOffset = pMemoryMapIndex->addressToOffset(pMemoryMap, nAddress, &cursor);
 
         if (nOffset == -1) {
             break;
         }
 
-        QByteArray baData = XBinary::read_array(pDevice, nOffset, 15);
+        qint32 nDataSize = 0;
+        char *pData = _readCache(pDevice, nOffset, m_nOpcodeSize, &nDataSize);
 
-        XDisasmAbstract::DISASM_RESULT _disasmResult = disAsm(baData.data(), baData.size(), nAddress, disasmOptions);
+        XDisasmAbstract::DISASM_RESULT _disasmResult = _disAsmFirst(pData, nDataSize, nAddress, disasmOptions);
 
         if (_disasmResult.bIsValid) {
-            baData.resize(_disasmResult.nSize);
+            qint32 nStart = result.baPattern.size();
+            qint32 nSize = qMin(_disasmResult.nSize, nDataSize);
+
+            if (pListInstructionOffsets) {
+                pListInstructionOffsets->append(nStart);
+            }
 
-            QString sHEX = baData.toHex().data();
+            result.baPattern.append(pData, nSize);
+            result.baMask.append(nSize, (char)0xFF);
 
             if ((signatureType == ST_FULL) || (signatureType == ST_MASK)) {
                 nAddress += _disasmResult.nSize;
 
                 if (signatureType == ST_MASK) {
                     if (_disasmResult.nDispSize) {
-                        sHEX = replaceWildChar(sHEX, _disasmResult.nDispOffset, _disasmResult.nDispSize, '.');
+                        _setWild(&result, nStart, _disasmResult.nDispOffset, _disasmResult.nDispSize);
                     }
 
                     if (_disasmResult.nImmSize) {
-                        sHEX = replaceWildChar(sHEX, _disasmResult.nImmOffset, _disasmResult.nImmSize, '.');
+                        _setWild(&result, nStart, _disasmResult.nImmOffset, _disasmResult.nImmSize);
                     }
                 }
             } else if (signatureType == ST_REL) {
@@ -152,11 +630,11 @@ QString XDisasmCore::getSignature(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMem
                     }
                 }
 
-                if (XDisasmAbstract::isBranchOpcode(m_disasmFamily, _disasmResult.nOpcode)) {
+                if ((XDisasmAbstract::getOpcodeClass(m_opcodeClassTable, _disasmResult.nOpcode) & XDisasmAbstract::OPCODECLASS_BRANCH)) {
                     // TODO another archs !!!
                     if (m_disasmFamily == XBinary::DMFAMILY_X86) {
                         if (_disasmResult.nImmSize) {
-                            sHEX = replaceWildChar(sHEX, _disasmResult.nImmOffset, _disasmResult.nImmSize, '$');
+                            _setRel(&result, nStart, _disasmResult.nImmOffset, _disasmResult.nImmSize);
                         }
 
                         bIsJump = true;
@@ -165,16 +643,14 @@ QString XDisasmCore::getSignature(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMem
 
                 if (!bIsJump) {
                     if (_disasmResult.nDispSize) {
-                        sHEX = replaceWildChar(sHEX, _disasmResult.nDispOffset, _disasmResult.nDispSize, '.');
+                        _setWild(&result, nStart, _disasmResult.nDispOffset, _disasmResult.nDispSize);
                     }
 
                     if (_disasmResult.nImmSize) {
-                        sHEX = replaceWildChar(sHEX, _disasmResult.nImmOffset, _disasmResult.nImmSize, '.');
+                        _setWild(&result, nStart, _disasmResult.nImmOffset, _disasmResult.nImmSize);
                     }
                 }
             }
-
-            sResult += sHEX;
         } else {
             break;
         }
@@ -182,28 +658,204 @@ QString XDisasmCore::getSignature(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMem
         nCount--;
     }
 
-    return sResult;
+    return result;
+}
+
+QString XDisasmCore::signatureToString(const SIGNATURE &signature)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+
+    qint32 nSize = signature.baPattern.size();
+
+    QByteArray baResult(nSize * 2, '.');
+
+    const char *pPattern = signature.baPattern.constData();
+    const char *pMask = signature.baMask.constData();
+    char *pResult = baResult.data();
+
+    for (qint32 i = 0; i < nSize; i++) {
+        if (pMask[i]) {
+            quint8 nByte = (quint8)pPattern[i];
+
+            pResult[i * 2] = hexDigits[nByte >> 4];
+            pResult[i * 2 + 1] = hexDigits[nByte & 0x0F];
+        }
+    }
+
+    qint32 nNumberOfRels = signature.listRels.count();
+
+    for (qint32 i = 0; i < nNumberOfRels; i++) {
+        memset(pResult + signature.listRels.at(i).nOffset * 2, '$', signature.listRels.at(i).nSize * 2);
+    }
+
+    return QString::fromLatin1(baResult);
+}
+
+bool XDisasmCore::stringToSignature(const QString &sSignature, SIGNATURE *pSignature)
+{
+    // Byte pairs: hex digits, ".." or "??" for any byte, "$$" for a byte of a relative branch field
+    *pSignature = SIGNATURE();
+
+    QByteArray baText = sSignature.toLatin1();
+    baText.replace(' ', "");
+
+    qint32 nSize = baText.size() / 2;
+    bool bResult = ((baText.size() % 2) == 0);
+
+    pSignature->baPattern.resize(nSize);
+    pSignature->baMask.resize(nSize);
+
+    for (qint32 i = 0; bResult && (i < nSize); i++) {
+        char cHigh = baText.at(i * 2);
+        char cLow = baText.at(i * 2 + 1);
+
+        if (((cHigh == '.') && (cLow == '.')) || ((cHigh == '?') && (cLow == '?'))) {
+            pSignature->baPattern[i] = 0;
+            pSignature->baMask[i] = 0;
+        } else if ((cHigh == '$') && (cLow == '$')) {
+            pSignature->baPattern[i] = 0;
+            pSignature->baMask[i] = 0;
+
+            qint32 nNumberOfRels = pSignature->listRels.count();
+
+            if (nNumberOfRels && ((pSignature->listRels.at(nNumberOfRels - 1).nOffset + pSignature->listRels.at(nNumberOfRels - 1).nSize) == i)) {
+                pSignature->listRels[nNumberOfRels - 1].nSize++;
+            } else {
+                SIGNATURE_REL rel = {};
+                rel.nOffset = i;
+                rel.nSize = 1;
+
+                pSignature->listRels.append(rel);
+            }
+        } else {
+            qint32 nHigh = _hexDigitValue(cHigh);
+            qint32 nLow = _hexDigitValue(cLow);
+
+            if ((nHigh != -1) && (nLow != -1)) {
+                pSignature->baPattern[i] = (char)((nHigh << 4) | nLow);
+                pSignature->baMask[i] = (char)0xFF;
+            } else {
+                bResult = false;
+            }
+        }
+    }
+
+    if (!bResult) {
+        *pSignature = SIGNATURE();
+    }
+
+    return bResult;
 }
 
 QList<XDisasmCore::SIGNATURE_RECORD> XDisasmCore::getSignatureRecords(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, qint64 nOffset, qint32 nCount,
                                                                       ST signatureType)
+{
+    return _getSignatureRecords(pDevice, nullptr, pMemoryMap, nOffset, nCount, signatureType);
+}
+
+QList<XDisasmCore::SIGNATURE_RECORD> XDisasmCore::getSignatureRecords(const MAPPED_INPUT *pMappedInput, XBinary::_MEMORY_MAP *pMemoryMap, qint64 nOffset,
+                                                                      qint32 nCount, ST signatureType)
+{
+    return _getSignatureRecords(nullptr, pMappedInput, pMemoryMap, nOffset, nCount, signatureType);
+}
+
+QList<QList<XDisasmCore::SIGNATURE_RECORD>> XDisasmCore::getSignatureRecordsBatch(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap,
+                                                                                  const QList<qint64> &listOffsets, qint32 nCount, ST signatureType,
+                                                                                  qint32 nNumberOfThreads, XBinary::PDSTRUCT *pPdStruct)
+{
+    qint32 nNumberOfOffsets = listOffsets.count();
+
+    QVector<QList<SIGNATURE_RECORD>> listResults(nNumberOfOffsets);
+
+    MAPPED_INPUT mappedInput = {};
+
+    if (mapInput(pDevice, nullptr, &mappedInput)) {
+        qint32 nFreeIndex = XBinary::getFreeIndex(pPdStruct);
+        XBinary::setPdStructInit(pPdStruct, nFreeIndex, nNumberOfOffsets);
+
+        // Looked up once here; the workers use it without the lock or the staleness check
+        QSharedPointer<const XMemoryMapIndex> pMemoryMapIndex = _getMemoryMapIndex(pMemoryMap);
+
+        if (nNumberOfThreads <= 0) {
+            nNumberOfThreads = QThread::idealThreadCount();
+        }
+
+        nNumberOfThreads = qBound(1, nNumberOfThreads, qMax(nNumberOfOffsets, 1));
+
+        QAtomicInt nNext = 0;
+        QAtomicInt nDone = 0;
+
+        QThreadPool threadPool;
+        threadPool.setMaxThreadCount(nNumberOfThreads);
+
+        for (qint32 i = 0; i < nNumberOfThreads; i++) {
+            threadPool.start(new XSignatureBatchTask(this, &mappedInput, pMemoryMap, pMemoryMapIndex, &listOffsets, nCount, signatureType, &nNext, &nDone,
+                                                     &listResults, pPdStruct));
+        }
+
+        // Progress is published from this thread only
+        while (!threadPool.waitForDone(100)) {
+            XBinary::setPdStructCurrent(pPdStruct, nFreeIndex, nDone.loadAcquire());
+        }
+
+        XBinary::setPdStructCurrent(pPdStruct, nFreeIndex, nDone.loadAcquire());
+        XBinary::setPdStructFinished(pPdStruct, nFreeIndex);
+    }
+
+    unmapInput(&mappedInput);
+
+    return listResults.toList();
+}
+
+QList<XDisasmCore::SIGNATURE_RECORD> XDisasmCore::_getSignatureRecords(QIODevice *pDevice, const MAPPED_INPUT *pMappedInput, XBinary::_MEMORY_MAP *pMemoryMap,
+                                                                       qint64 nOffset, qint32 nCount, ST signatureType,
+                                                                       QSharedPointer<const XMemoryMapIndex> pMemoryMapIndex)
 {
     QList<SIGNATURE_RECORD> listResult;
 
     XDisasmAbstract::DISASM_OPTIONS disasmOptions = {};
 
-    bool bStopBranch = false;
+    if (pMemoryMapIndex.isNull()) {
+        pMemoryMapIndex = _getMemoryMapIndex(pMemoryMap);
+    }
+
+    XMemoryMapIndex::CURSOR cursor = XMemoryMapIndex::getCursor();
+
+    bool bStopBranch = (m_pDisasmAbstract == nullptr);
 
     for (qint32 i = 0; (i < nCount) && (!bStopBranch); i++) {
         if (nOffset != -1) {
-            XADDR nAddress = XBinary::offsetToAddress(pMemoryMap, nOffset);
-
-            QByteArray baData = XBinary::read_array(pDevice, nOffset, 15);
+            XADDR nAddress = pMemoryMapIndex->offsetToAddress(pMemoryMap, nOffset, &cursor);
+
+            qint32 nDataSize = 0;
+            char *pData = nullptr;
+            char buffer[N_SIGNATURE_BUFFER_SIZE] = {};
+            XDisasmAbstract::DISASM_RESULT _disasmResult = {};
+
+            if (pMappedInput) {
+                // Shared state only: the bytes come from the mapping and the decoder from the pool
+                nDataSize = (qint32)qBound((qint64)0, pMappedInput->nSize - nOffset, (qint64)m_nOpcodeSize);
+                pData = buffer;
+
+                if (nDataSize) {
+                    if ((nOffset + N_SIGNATURE_BUFFER_SIZE) <= pMappedInput->nSize) {
+                        pData = pMappedInput->pData + nOffset;
+                    } else {
+                        // WORKAROUND: zero padding after the last bytes, as in the read cache
+                        memcpy(buffer, pMappedInput->pData + nOffset, nDataSize);
+                    }
+                }
 
-            XDisasmAbstract::DISASM_RESULT _disasmResult = disAsm(baData.data(), baData.size(), nAddress, disasmOptions);
+                XDisasmFirstSink sink;
+                disAsmStreamShared(pData, nDataSize, nAddress, disasmOptions, &sink);
+                _disasmResult = sink.m_disasmResult;
+            } else {
+                pData = _readCache(pDevice, nOffset, m_nOpcodeSize, &nDataSize);
+                _disasmResult = _disAsmFirst(pData, nDataSize, nAddress, disasmOptions);
+            }
 
             if (_disasmResult.bIsValid) {
-                bStopBranch = !XBinary::isOffsetValid(pMemoryMap, nOffset + _disasmResult.nSize - 1);
+                bStopBranch = !pMemoryMapIndex->isOffsetValid(pMemoryMap, nOffset + _disasmResult.nSize - 1, &cursor);
 
                 if (!bStopBranch) {
                     XDisasmCore::SIGNATURE_RECORD record = {};
@@ -215,9 +867,7 @@ QList<XDisasmCore::SIGNATURE_RECORD> XDisasmCore::getSignatureRecords(QIODevice
                         record.sOpcode += " " + _disasmResult.sOperands;
                     }
 
-                    baData.resize(_disasmResult.nSize);
-
-                    record.baOpcode = baData;
+                    record.baOpcode = QByteArray(pData, qMin(_disasmResult.nSize, nDataSize));
 
                     record.nDispOffset = _disasmResult.nDispOffset;
                     record.nDispSize = _disasmResult.nDispSize;
@@ -243,13 +893,39 @@ QList<XDisasmCore::SIGNATURE_RECORD> XDisasmCore::getSignatureRecords(QIODevice
                 bStopBranch = true;
             }
 
-            nOffset = XBinary::addressToOffset(pMemoryMap, nAddress);
+            nOffset = pMemoryMapIndex->addressToOffset(pMemoryMap, nAddress, &cursor);
         }
     }
 
     return listResult;
 }
 
+QSharedPointer<const XMemoryMapIndex> XDisasmCore::_getMemoryMapIndex(XBinary::_MEMORY_MAP *pMemoryMap)
+{
+    QMutexLocker locker(&m_mutexMemoryMapIndex);
+
+    if (m_pMemoryMapIndex.isNull() || (!m_pMemoryMapIndex->isBuiltFor(pMemoryMap))) {
+        // Callers still holding the previous index keep reading it unchanged
+        QSharedPointer<XMemoryMapIndex> pMemoryMapIndex(new XMemoryMapIndex);
+        pMemoryMapIndex->build(pMemoryMap);
+
+        m_pMemoryMapIndex = pMemoryMapIndex;
+    }
+
+    return m_pMemoryMapIndex;
+}
+
+XDisasmAbstract::DISASM_RESULT XDisasmCore::_disAsmFirst(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions)
+{
+    XDisasmFirstSink sink;
+
+    if (m_pDisasmAbstract) {
+        m_pDisasmAbstract->_disasm(pData, nDataSize, nAddress, disasmOptions, &sink, nullptr);
+    }
+
+    return sink.m_disasmResult;
+}
+
 QString XDisasmCore::replaceWildChar(const QString &sString, qint32 nOffset, qint32 nSize, QChar cWild)
 {
     QString sResult = sString;
@@ -269,32 +945,51 @@ QString XDisasmCore::getNumberString(qint64 nValue)
 
 XOptions::COLOR_RECORD XDisasmCore::getOperandColor(const QString &sOperand)
 {
-    XOptions::COLOR_RECORD result = {};
+    return getOperandColor(sOperand.constData(), sOperand.size());
+}
+
+XOptions::COLOR_RECORD XDisasmCore::getOperandColor(const QChar *pData, qint32 nSize)
+{
+    // All classes in one pass
+    return getOperandClassColor(XDisasmAbstract::getOperandClass(m_disasmFamily, pData, nSize, m_syntax));
+}
 
-    if (XDisasmAbstract::isRef(m_disasmFamily, sOperand, m_syntax)) {
-        result = getColorRecord(XDisasmCore::OG_REFS);
-    } else if (XDisasmAbstract::isGeneralRegister(m_disasmFamily, sOperand, m_syntax)) {
-        result = getColorRecord(XDisasmCore::OG_REGS_GENERAL);
-    } else if (XDisasmAbstract::isStackRegister(m_disasmFamily, sOperand, m_syntax)) {
-        result = getColorRecord(XDisasmCore::OG_REGS_STACK);
-    } else if (XDisasmAbstract::isSegmentRegister(m_disasmFamily, sOperand, m_syntax)) {
-        result = getColorRecord(XDisasmCore::OG_REGS_SEGMENT);
-    } else if (XDisasmAbstract::isDebugRegister(m_disasmFamily, sOperand, m_syntax)) {
-        result = getColorRecord(XDisasmCore::OG_REGS_DEBUG);
-    } else if (XDisasmAbstract::isInstructionPointerRegister(m_disasmFamily, sOperand, m_syntax)) {
-        result = getColorRecord(XDisasmCore::OG_REGS_IP);
-    } else if (XDisasmAbstract::isFlagsRegister(m_disasmFamily, sOperand, m_syntax)) {
-        result = getColorRecord(XDisasmCore::OG_REGS_FLAGS);
-    } else if (XDisasmAbstract::isFPURegister(m_disasmFamily, sOperand, m_syntax)) {
-        result = getColorRecord(XDisasmCore::OG_REGS_FPU);
-    } else if (XDisasmAbstract::isXMMRegister(m_disasmFamily, sOperand, m_syntax)) {
-        result = getColorRecord(XDisasmCore::OG_REGS_XMM);
-    } else if (XDisasmAbstract::isNumber(m_disasmFamily, sOperand, m_syntax)) {
-        result = getColorRecord(XDisasmCore::OG_NUMBERS);
-    }
-
-    if (XDisasmAbstract::isRegister(m_disasmFamily, sOperand, m_syntax) && result.sColorMain.isEmpty() && result.sColorBackground.isEmpty()) {
-        result = getColorRecord(XDisasmCore::OG_REGS);
+XOptions::COLOR_RECORD XDisasmCore::getOperandClassColor(quint16 nOperandClass)
+{
+    return getColorRecord(_getOperandClassOG(nOperandClass));
+}
+
+XDisasmCore::OG XDisasmCore::_getOperandClassOG(quint16 nOperandClass) const
+{
+    OG result = OG_UNKNOWN;
+
+    // The order below is the color priority; separators are not colored
+    if (nOperandClass && !(nOperandClass & XDisasmAbstract::OPERANDCLASS_SEPARATOR)) {
+        if (nOperandClass & XDisasmAbstract::OPERANDCLASS_REF) {
+            result = OG_REFS;
+        } else if (nOperandClass & XDisasmAbstract::OPERANDCLASS_GENERAL) {
+            result = OG_REGS_GENERAL;
+        } else if (nOperandClass & XDisasmAbstract::OPERANDCLASS_STACK) {
+            result = OG_REGS_STACK;
+        } else if (nOperandClass & XDisasmAbstract::OPERANDCLASS_SEGMENT) {
+            result = OG_REGS_SEGMENT;
+        } else if (nOperandClass & XDisasmAbstract::OPERANDCLASS_DEBUG) {
+            result = OG_REGS_DEBUG;
+        } else if (nOperandClass & XDisasmAbstract::OPERANDCLASS_IP) {
+            result = OG_REGS_IP;
+        } else if (nOperandClass & XDisasmAbstract::OPERANDCLASS_FLAGS) {
+            result = OG_REGS_FLAGS;
+        } else if (nOperandClass & XDisasmAbstract::OPERANDCLASS_FPU) {
+            result = OG_REGS_FPU;
+        } else if (nOperandClass & XDisasmAbstract::OPERANDCLASS_XMM) {
+            result = OG_REGS_XMM;
+        } else if (nOperandClass & XDisasmAbstract::OPERANDCLASS_NUMBER) {
+            result = OG_NUMBERS;
+        }
+
+        if ((nOperandClass & XDisasmAbstract::OPERANDCLASS_REGISTER) && (!m_listColors.at(result).bIsSet)) {
+            result = OG_REGS;
+        }
     }
 
     return result;
@@ -310,7 +1005,52 @@ static void _disasmAddPart(XColorString *pResult, const QString &sString, const
 XColorString XDisasmCore::convertDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult)
 {
     XColorString result;
-    XOptions::COLOR_RECORD emptyColorRecord = {};
+
+    RENDERCACHE_ENTRY *pEntry = nullptr;
+
+    if (m_renderCache.maxCost() > 0) {
+        pEntry = m_renderCache.object(disasmResult.nAddress);
+    }
+
+    if (pEntry && (pEntry->nColorGeneration == m_nColorGeneration) && (pEntry->nOpcode == disasmResult.nOpcode) && (pEntry->nSize == disasmResult.nSize) &&
+        (pEntry->sMnemonic == disasmResult.sMnemonic) && (pEntry->sOperands == disasmResult.sOperands)) {
+        result = pEntry->colorString;
+    } else {
+        result = _convertDisasmResult(disasmResult);
+
+        if (m_renderCache.maxCost() > 0) {
+            RENDERCACHE_ENTRY *pNewEntry = new RENDERCACHE_ENTRY;
+            pNewEntry->nColorGeneration = m_nColorGeneration;
+            pNewEntry->nOpcode = disasmResult.nOpcode;
+            pNewEntry->nSize = disasmResult.nSize;
+            pNewEntry->sMnemonic = disasmResult.sMnemonic;
+            pNewEntry->sOperands = disasmResult.sOperands;
+            pNewEntry->colorString = result;
+
+            // The text is held by the entry and again by the parts; part headers are counted as much again
+            qint32 nCost = (qint32)sizeof(RENDERCACHE_ENTRY) + 4 * (disasmResult.sMnemonic.size() + disasmResult.sOperands.size() + 1) * (qint32)sizeof(QChar);
+
+            m_renderCache.insert(disasmResult.nAddress, pNewEntry, nCost);
+        }
+    }
+
+    return result;
+}
+
+void XDisasmCore::setRenderCacheSize(qint32 nMaxBytes)
+{
+    m_renderCache.setMaxCost(qMax(nMaxBytes, 0));
+}
+
+void XDisasmCore::clearRenderCache()
+{
+    m_renderCache.clear();
+}
+
+XColorString XDisasmCore::_convertDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult)
+{
+    XColorString result;
+    XOptions::COLOR_RECORD emptyColorRecord = {};
     XOptions::COLOR_RECORD opcodeColorRecord = getOpcodeColor(disasmResult.nOpcode);
 
     _disasmAddPart(&result, disasmResult.sMnemonic, opcodeColorRecord);
@@ -318,30 +1058,37 @@ XColorString XDisasmCore::convertDisasmResult(const XDisasmAbstract::DISASM_RESU
     if (!disasmResult.sOperands.isEmpty()) {
         _disasmAddPart(&result, " ", emptyColorRecord);
 
-        if (XDisasmAbstract::isNopOpcode(m_disasmFamily, disasmResult.nOpcode)) {
+        if ((XDisasmAbstract::getOpcodeClass(m_opcodeClassTable, disasmResult.nOpcode) & XDisasmAbstract::OPCODECLASS_NOP)) {
             _disasmAddPart(&result, disasmResult.sOperands, opcodeColorRecord);
         } else {
-            QString sCurrent;
-            const QString sSeparators = ",[]+-*(): ";
-            qint32 nNumberOfChars = disasmResult.sOperands.size();
+            // Spans from the decoder (bOperandTokens); otherwise the operands are tokenized here the same way. Decoder spans
+            // only count if they still cover sOperands exactly: a caller may have edited the text (symbols, labels) since.
+            QVector<XDisasmAbstract::OPERAND_TOKEN> _listOperandTokens;
+            const QVector<XDisasmAbstract::OPERAND_TOKEN> *pListOperandTokens = &(disasmResult.listOperandTokens);
 
-            for (qint32 i = 0; i < nNumberOfChars; i++) {
-                QChar ch = disasmResult.sOperands.at(i);
+            bool bIsSpansValid = !pListOperandTokens->isEmpty();
 
-                if (sSeparators.contains(ch)) {
-                    if (!sCurrent.isEmpty()) {
-                        _disasmAddPart(&result, sCurrent, getOperandColor(sCurrent));
-                        sCurrent.clear();
-                    }
+            if (bIsSpansValid) {
+                const XDisasmAbstract::OPERAND_TOKEN &tokenLast = pListOperandTokens->last();
 
-                    _disasmAddPart(&result, QString(ch), emptyColorRecord);
-                } else {
-                    sCurrent.append(ch);
-                }
+                bIsSpansValid = ((tokenLast.nOffset + tokenLast.nSize) == disasmResult.sOperands.size());
+            }
+
+            if (!bIsSpansValid) {
+                XDisasmAbstract::tokenizeOperands(m_disasmFamily, disasmResult.sOperands, m_syntax, &_listOperandTokens);
+                pListOperandTokens = &_listOperandTokens;
+            }
+
+            qint32 nNumberOfTokens = pListOperandTokens->count();
+
+            for (qint32 i = 0; i < nNumberOfTokens; i++) {
+                const XDisasmAbstract::OPERAND_TOKEN &token = pListOperandTokens->at(i);
+
+                _disasmAddPart(&result, disasmResult.sOperands.mid(token.nOffset, token.nSize), getColorRecord(_getOperandClassOG(token.nClass)));
             }
 
-            if (!sCurrent.isEmpty()) {
-                _disasmAddPart(&result, sCurrent, getOperandColor(sCurrent));
+            if (nNumberOfTokens == 0) {
+                _disasmAddPart(&result, disasmResult.sOperands, emptyColorRecord);
             }
         }
     }
@@ -349,6 +1096,15 @@ XColorString XDisasmCore::convertDisasmResult(const XDisasmAbstract::DISASM_RESU
     return result;
 }
 
+XColorString XDisasmCore::convertDisasmRecord(const XDisasmAbstract::DISASM_RECORD &record, QIODevice *pDevice, qint64 nOffset,
+                                              const XDisasmAbstract::DISASM_OPTIONS &disasmOptions)
+{
+    XDisasmAbstract::DISASM_OPTIONS _disasmOptions = disasmOptions;
+    _disasmOptions.bOperandTokens = true;
+
+    return convertDisasmResult(formatRecord(record, pDevice, nOffset, _disasmOptions));
+}
+
 #ifdef QT_GUI_LIB
 void XDisasmCore::drawDisasmText(QPainter *pPainter, QRectF rectText, const XDisasmAbstract::DISASM_RESULT &disasmResult)
 {
@@ -362,11 +1118,36 @@ void XDisasmCore::drawDisasmText(QPainter *pPainter, QRectF rectText, const XDis
 void XDisasmCore::drawOperand(QPainter *pPainter, QRectF rectText, const QString &sOperand)
 {
     if (pPainter) {
-        drawColorText(pPainter, rectText, sOperand, getOperandColor(sOperand));
+        OG og = _getOperandClassOG(XDisasmAbstract::getOperandClass(m_disasmFamily, sOperand.constData(), sOperand.size(), m_syntax));
+        _drawColorText(pPainter, rectText, sOperand, m_listColors.at(og));
     }
 }
 #endif
 #ifdef QT_GUI_LIB
+void XDisasmCore::_drawColorText(QPainter *pPainter, const QRectF &rect, const QString &sText, const COLOR_ENTRY &colorEntry)
+{
+    if (colorEntry.bIsSet) {
+        pPainter->save();
+
+        QRectF _rectString = rect;
+        _rectString.setWidth(QFontMetrics(pPainter->font()).size(Qt::TextSingleLine, sText).width());
+
+        if (!colorEntry.colorRecord.sColorBackground.isEmpty()) {
+            pPainter->fillRect(_rectString, QBrush(colorEntry.colorBackground));
+        }
+
+        if (!colorEntry.colorRecord.sColorMain.isEmpty()) {
+            pPainter->setPen(colorEntry.colorMain);
+        }
+
+        pPainter->drawText(_rectString, sText, m_qTextOptions);
+
+        pPainter->restore();
+    } else {
+        pPainter->drawText(rect, sText, m_qTextOptions);
+    }
+}
+
 void XDisasmCore::drawColorText(QPainter *pPainter, const QRectF &rect, const QString &sText, const XOptions::COLOR_RECORD &colorRecord)
 {
     if ((colorRecord.sColorMain != "") || (colorRecord.sColorBackground != "")) {
@@ -393,30 +1174,40 @@ void XDisasmCore::drawColorText(QPainter *pPainter, const QRectF &rect, const QS
 #endif
 XOptions::COLOR_RECORD XDisasmCore::getOpcodeColor(quint32 nOpcode)
 {
-    XOptions::COLOR_RECORD result = {};
+    return getColorRecord(_getOpcodeOG(nOpcode));
+}
 
-    if (XDisasmAbstract::isCallOpcode(m_disasmFamily, nOpcode)) {
-        result = getColorRecord(XDisasmCore::OG_OPCODE_CALL);
-    } else if (XDisasmAbstract::isCondJumpOpcode(m_disasmFamily, nOpcode)) {
-        result = getColorRecord(XDisasmCore::OG_OPCODE_CONDJMP);
-    } else if (XDisasmAbstract::isRetOpcode(m_disasmFamily, nOpcode)) {
-        result = getColorRecord(XDisasmCore::OG_OPCODE_RET);
-    } else if (XDisasmAbstract::isPushOpcode(m_disasmFamily, nOpcode)) {
-        result = getColorRecord(XDisasmCore::OG_OPCODE_PUSH);
-    } else if (XDisasmAbstract::isPopOpcode(m_disasmFamily, nOpcode)) {
-        result = getColorRecord(XDisasmCore::OG_OPCODE_POP);
-    } else if (XDisasmAbstract::isNopOpcode(m_disasmFamily, nOpcode)) {
-        result = getColorRecord(XDisasmCore::OG_OPCODE_NOP);
-    } else if (XDisasmAbstract::isJumpOpcode(m_disasmFamily, nOpcode)) {
-        result = getColorRecord(XDisasmCore::OG_OPCODE_JMP);
-    } else if (XDisasmAbstract::isInt3Opcode(m_disasmFamily, nOpcode)) {
-        result = getColorRecord(XDisasmCore::OG_OPCODE_INT3);
-    } else if (XDisasmAbstract::isSyscallOpcode(m_disasmFamily, nOpcode)) {
-        result = getColorRecord(XDisasmCore::OG_OPCODE_SYSCALL);
-    }
-
-    if ((result.sColorMain == "") && (result.sColorBackground == "")) {
-        result = getColorRecord(XDisasmCore::OG_OPCODE);
+XDisasmCore::OG XDisasmCore::_getOpcodeOG(quint32 nOpcode) const
+{
+    OG result = OG_UNKNOWN;
+
+    // One table load; the order below is the color priority when an opcode has several classes
+    quint16 nOpcodeClass = XDisasmAbstract::getOpcodeClass(m_opcodeClassTable, nOpcode);
+
+    if (nOpcodeClass) {
+        if (nOpcodeClass & XDisasmAbstract::OPCODECLASS_CALL) {
+            result = OG_OPCODE_CALL;
+        } else if (nOpcodeClass & XDisasmAbstract::OPCODECLASS_CONDJMP) {
+            result = OG_OPCODE_CONDJMP;
+        } else if (nOpcodeClass & XDisasmAbstract::OPCODECLASS_RET) {
+            result = OG_OPCODE_RET;
+        } else if (nOpcodeClass & XDisasmAbstract::OPCODECLASS_PUSH) {
+            result = OG_OPCODE_PUSH;
+        } else if (nOpcodeClass & XDisasmAbstract::OPCODECLASS_POP) {
+            result = OG_OPCODE_POP;
+        } else if (nOpcodeClass & XDisasmAbstract::OPCODECLASS_NOP) {
+            result = OG_OPCODE_NOP;
+        } else if (nOpcodeClass & XDisasmAbstract::OPCODECLASS_JMP) {
+            result = OG_OPCODE_JMP;
+        } else if (nOpcodeClass & XDisasmAbstract::OPCODECLASS_INT3) {
+            result = OG_OPCODE_INT3;
+        } else if (nOpcodeClass & XDisasmAbstract::OPCODECLASS_SYSCALL) {
+            result = OG_OPCODE_SYSCALL;
+        }
+    }
+
+    if (!m_listColors.at(result).bIsSet) {
+        result = OG_OPCODE;
     }
 
     return result;
@@ -541,21 +1332,204 @@ QMap<XDisasmCore::OG, XOptions::COLOR_RECORD> XDisasmCore::getColorRecordsMap(XO
     return mapResult;
 }
 
-XOptions::COLOR_RECORD XDisasmCore::getColorRecord(OG og)
+const XOptions::COLOR_RECORD &XDisasmCore::getColorRecord(OG og) const
 {
-    return m_mapColors.value(og);
+    return m_listColors.at(((qint32)og < m_listColors.count()) ? og : OG_UNKNOWN).colorRecord;
 }
 
 XDisasmAbstract::DISASM_RESULT XDisasmCore::disAsm(QIODevice *pDevice, qint64 nOffset, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions)
 {
-    QByteArray baData = XBinary::read_array(pDevice, nOffset, m_nOpcodeSize);
+    XDisasmAbstract::DISASM_RESULT result = {};
+
+    bool bIsCache = (m_decodeCache.maxCost() > 0);
+    bool bIsHit = false;
+    quint32 nOptionFlags = 0;
+
+    if (bIsCache) {
+        if (pDevice != m_pDecodeCacheDevice) {
+            QIODevice *pOldDevice = m_pDecodeCacheDevice;
 
-    int nRealSize = baData.size();
+            clearDecodeCache();
+            m_pDecodeCacheDevice = pDevice;
 
-    // WORKAROUND: Pad with 16 bytes to prevent Capstone lookahead.
-    baData.append(16, '\0');
+            _unwatchDevice(pOldDevice);
+            _watchDevice(pDevice);
+        }
+
+        nOptionFlags = (disasmOptions.bIsUppercase ? 0x1 : 0) | (disasmOptions.bNoStrings ? 0x2 : 0) | (disasmOptions.bLengthOnly ? 0x4 : 0) |
+                       (disasmOptions.bNoXrefs ? 0x8 : 0) | (disasmOptions.bOperandTokens ? 0x10 : 0);
+
+        DECODECACHE_ENTRY *pEntry = m_decodeCache.object(nAddress);
 
-    return disAsm(baData.data(), nRealSize, nAddress, disasmOptions);
+        if (pEntry && (pEntry->nOffset == nOffset) && (pEntry->nOptionFlags == nOptionFlags)) {
+            result = pEntry->disasmResult;
+            bIsHit = true;
+            m_nDecodeCacheHits++;
+        } else {
+            m_nDecodeCacheMisses++;
+        }
+    }
+
+    if (!bIsHit) {
+        qint32 nRealSize = 0;
+        char *pData = _readCache(pDevice, nOffset, m_nOpcodeSize, &nRealSize);
+
+        result = disAsm(pData, nRealSize, nAddress, disasmOptions);
+    }
+
+    if (bIsCache && (!bIsHit)) {
+        DECODECACHE_ENTRY *pEntry = new DECODECACHE_ENTRY;
+        pEntry->nOffset = nOffset;
+        pEntry->nOptionFlags = nOptionFlags;
+        pEntry->disasmResult = result;
+
+        m_decodeCache.insert(nAddress, pEntry);
+        m_mapDecodeCacheOffsets.insert(nAddress, nOffset);
+
+        // Evictions are silent, so the side index is pruned once it is twice the size of the cache
+        if (m_mapDecodeCacheOffsets.count() > 2 * m_decodeCache.maxCost()) {
+            QHash<XADDR, qint64>::iterator iter = m_mapDecodeCacheOffsets.begin();
+
+            while (iter != m_mapDecodeCacheOffsets.end()) {
+                if (m_decodeCache.contains(iter.key())) {
+                    ++iter;
+                } else {
+                    iter = m_mapDecodeCacheOffsets.erase(iter);
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+void XDisasmCore::setDecodeCacheSize(qint32 nMaxEntries)
+{
+    m_decodeCache.setMaxCost(qMax(nMaxEntries, 0));
+}
+
+void XDisasmCore::clearDecodeCache()
+{
+    m_decodeCache.clear();
+    m_mapDecodeCacheOffsets.clear();
+}
+
+void XDisasmCore::notifyBytesChanged(qint64 nOffset, qint64 nSize)
+{
+    resetReadCache();
+
+    // An instruction that starts up to m_nOpcodeSize bytes before the change may cover it. The offsets come from the
+    // side index: QCache::object() would move every visited entry to the front of the LRU.
+    QHash<XADDR, qint64>::iterator iter = m_mapDecodeCacheOffsets.begin();
+
+    while (iter != m_mapDecodeCacheOffsets.end()) {
+        if ((iter.value() < (nOffset + nSize)) && ((iter.value() + m_nOpcodeSize) > nOffset)) {
+            m_decodeCache.remove(iter.key());
+            iter = m_mapDecodeCacheOffsets.erase(iter);
+        } else if (!m_decodeCache.contains(iter.key())) {
+            iter = m_mapDecodeCacheOffsets.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+quint64 XDisasmCore::getDecodeCacheHits() const
+{
+    return m_nDecodeCacheHits;
+}
+
+quint64 XDisasmCore::getDecodeCacheMisses() const
+{
+    return m_nDecodeCacheMisses;
+}
+
+void XDisasmCore::resetReadCache()
+{
+    QIODevice *pOldDevice = m_pReadCacheDevice;
+
+    m_pReadCacheDevice = nullptr;
+
+    _unwatchDevice(pOldDevice);
+    _dropReadCache();
+}
+
+void XDisasmCore::_onDeviceBytesChanged()
+{
+    QObject *pDevice = sender();
+
+    if (pDevice == m_pReadCacheDevice) {
+        _dropReadCache();
+    }
+
+    if (pDevice == m_pDecodeCacheDevice) {
+        clearDecodeCache();
+    }
+}
+
+void XDisasmCore::_watchDevice(QIODevice *pDevice)
+{
+    // Direct: the caches are dropped as soon as the device reports the change, even without an event loop here
+    connect(pDevice, &QIODevice::bytesWritten, this, &XDisasmCore::_onDeviceBytesChanged, Qt::ConnectionType(Qt::DirectConnection | Qt::UniqueConnection));
+    connect(pDevice, &QIODevice::readyRead, this, &XDisasmCore::_onDeviceBytesChanged, Qt::ConnectionType(Qt::DirectConnection | Qt::UniqueConnection));
+}
+
+void XDisasmCore::_unwatchDevice(QIODevice *pDevice)
+{
+    if (pDevice && (pDevice != m_pReadCacheDevice) && (pDevice != m_pDecodeCacheDevice)) {
+        disconnect(pDevice, nullptr, this, nullptr);
+    }
+}
+
+void XDisasmCore::_dropReadCache()
+{
+    // The device stays attached; the next lookup is a miss
+    m_nReadCacheOffset = 0;
+    m_nReadCacheSize = 0;
+    m_bReadCacheEnd = false;
+    m_baReadCache.clear();
+}
+
+char *XDisasmCore::_readCache(QIODevice *pDevice, qint64 nOffset, qint32 nSize, qint32 *pnRealSize)
+{
+    // Successive lookups are served from one aligned block. The block is read with nSize extra bytes so an
+    // instruction that starts near its end (straddling into the next block) is still complete in memory.
+    qint64 nCacheEnd = m_nReadCacheOffset + m_nReadCacheSize;
+
+    bool bHit = (pDevice == m_pReadCacheDevice) && (nOffset >= m_nReadCacheOffset) &&
+                (((nOffset + nSize) <= nCacheEnd) || (m_bReadCacheEnd && (nOffset <= nCacheEnd)));
+
+    if (!bHit) {
+        if (pDevice != m_pReadCacheDevice) {
+            resetReadCache();
+
+            m_pReadCacheDevice = pDevice;
+
+            _watchDevice(pDevice);
+        }
+
+        qint64 nBlockOffset = nOffset & ~(N_READCACHE_BLOCK_SIZE - 1);
+        qint64 nBlockSize = N_READCACHE_BLOCK_SIZE + nSize;
+
+        m_baReadCache = XBinary::read_array(pDevice, nBlockOffset, nBlockSize);
+        m_nReadCacheOffset = nBlockOffset;
+        m_nReadCacheSize = m_baReadCache.size();
+        m_bReadCacheEnd = (m_nReadCacheSize < nBlockSize);
+
+        // WORKAROUND: Pad with 16 bytes to prevent Capstone lookahead.
+        m_baReadCache.append(N_READCACHE_PADDING, '\0');
+
+        nCacheEnd = m_nReadCacheOffset + m_nReadCacheSize;
+    }
+
+    *pnRealSize = (qint32)qBound((qint64)0, nCacheEnd - nOffset, (qint64)nSize);
+
+    if (nOffset > nCacheEnd) {
+        // Past the end of the device: point at the padding
+        return m_baReadCache.data() + m_nReadCacheSize;
+    }
+
+    return m_baReadCache.data() + (nOffset - m_nReadCacheOffset);
 }
 
 QList<XDisasmAbstract::DISASM_RESULT> XDisasmCore::disAsmList(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions,
@@ -564,18 +1538,42 @@ QList<XDisasmAbstract::DISASM_RESULT> XDisasmCore::disAsmList(char *pData, qint3
     QList<XDisasmAbstract::DISASM_RESULT> listResult;
 
     if (m_pDisasmAbstract) {
-        listResult = m_pDisasmAbstract->_disasm(pData, nDataSize, nAddress, disasmOptions, nLimit, pPdStruct);
+        listResult = m_pDisasmAbstract->_disasmList(pData, nDataSize, nAddress, disasmOptions, nLimit, pPdStruct);
+
+        if (m_pCheckpoints && m_pCheckpoints->beginSweep(nAddress)) {
+            qint32 nNumberOfResults = listResult.count();
+
+            for (qint32 i = 0; i < nNumberOfResults; i++) {
+                if (listResult.at(i).bIsValid) {
+                    m_pCheckpoints->addInstruction(listResult.at(i).nAddress);
+                }
+            }
+        }
     }
 
     return listResult;
 }
 
+void XDisasmCore::setCheckpoints(XDisasmCheckpoints *pCheckpoints)
+{
+    m_pCheckpoints = pCheckpoints;
+}
+
+void XDisasmCore::disAsmStream(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink,
+                               XBinary::PDSTRUCT *pPdStruct)
+{
+    if (m_pDisasmAbstract) {
+        m_pDisasmAbstract->_disasm(pData, nDataSize, nAddress, disasmOptions, pSink, pPdStruct);
+    }
+}
+
 XDisasmAbstract::DISASM_RESULT XDisasmCore::disAsm(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions)
 {
     XDisasmAbstract::DISASM_RESULT result = {};
 
     if (m_pDisasmAbstract) {
-        QList<XDisasmAbstract::DISASM_RESULT> list = disAsmList(pData, nDataSize, nAddress, disasmOptions, 1);
+        // Not through disAsmList: a single decode is not a sweep and must not become a checkpoint
+        QList<XDisasmAbstract::DISASM_RESULT> list = m_pDisasmAbstract->_disasmList(pData, nDataSize, nAddress, disasmOptions, 1, nullptr);
 
         if (list.count()) {
             result = list.at(0);
@@ -584,3 +1582,325 @@ XDisasmAbstract::DISASM_RESULT XDisasmCore::disAsm(char *pData, qint32 nDataSize
 
     return result;
 }
+
+QVector<XDisasmAbstract::DISASM_RECORD> XDisasmCore::disAsmRecords(char *pData, qint32 nDataSize, XADDR nAddress, qint32 nLimit, XBinary::PDSTRUCT *pPdStruct)
+{
+    XDisasmAbstract::DISASM_OPTIONS disasmOptions = {};
+    disasmOptions.bLengthOnly = true;
+
+    XDisasmRecordSink sink(nLimit);
+
+    disAsmStream(pData, nDataSize, nAddress, disasmOptions, &sink, pPdStruct);
+
+    return sink.getRecords();
+}
+
+bool XDisasmCore::reDisAsmRecords(QVector<XDisasmAbstract::DISASM_RECORD> *pListRecords, char *pData, qint64 nDataSize, XADDR nAddress, qint64 nPatchOffset,
+                                  qint64 nPatchSize, REDISASM_RESULT *pResult)
+{
+    *pResult = REDISASM_RESULT();
+
+    bool bResult = false;
+
+    if (m_pDisasmAbstract && (nPatchOffset >= 0) && (nPatchSize > 0) && (nPatchOffset < nDataSize)) {
+        XADDR nPatchAddress = nAddress + nPatchOffset;
+        XADDR nPatchEnd = nPatchAddress + qMin(nPatchSize, nDataSize - nPatchOffset);
+
+        // The decoder reads up to m_nOpcodeSize bytes from an instruction start, so every instruction that ends after
+        // nPatchAddress - m_nOpcodeSize may have been decoded from the old bytes (an invalid 1-byte db may become a
+        // valid instruction now). The sweep restarts at the first of them and resyncs after the patch.
+        XADDR nLookbehind = nAddress;
+
+        if ((nPatchAddress - nAddress) > (XADDR)m_nOpcodeSize) {
+            nLookbehind = nPatchAddress - m_nOpcodeSize;
+        }
+
+        qint32 nNumberOfRecords = pListRecords->count();
+        qint32 nLeft = 0;
+        qint32 nRight = nNumberOfRecords;
+
+        while (nLeft < nRight) {
+            qint32 nMiddle = nLeft + (nRight - nLeft) / 2;
+            const XDisasmAbstract::DISASM_RECORD &record = pListRecords->at(nMiddle);
+
+            if ((record.nAddress + record.nSize) <= nLookbehind) {
+                nLeft = nMiddle + 1;
+            } else {
+                nRight = nMiddle;
+            }
+        }
+
+        qint32 nFirstIndex = nLeft;
+        XADDR nStart = nAddress;
+
+        if (nFirstIndex < nNumberOfRecords) {
+            nStart = qMin(pListRecords->at(nFirstIndex).nAddress, nPatchAddress);
+        } else if (nNumberOfRecords) {
+            nStart = pListRecords->at(nNumberOfRecords - 1).nAddress + pListRecords->at(nNumberOfRecords - 1).nSize;
+        }
+
+        if ((nStart >= nAddress) && ((qint64)(nStart - nAddress) < nDataSize)) {
+            qint64 nDelta = (qint64)(nStart - nAddress);
+
+            XDisasmAbstract::DISASM_OPTIONS disasmOptions = {};
+            disasmOptions.bLengthOnly = true;
+
+            QVector<XDisasmAbstract::DISASM_RECORD> listNew;
+            XDisasmRealignSink sink(pListRecords, nFirstIndex, nPatchEnd, &listNew);
+
+            disAsmStream(pData + nDelta, (qint32)qMin(nDataSize - nDelta, N_REGION_CHUNK_SIZE), nStart, disasmOptions, &sink);
+
+            qint32 nNumberOfRemoved = (sink.m_bIsRealigned ? sink.m_nOldIndex : nNumberOfRecords) - nFirstIndex;
+            qint32 nNumberOfInserted = listNew.count();
+
+            // Resize the span in place so the tail moves at most once
+            if (nNumberOfInserted > nNumberOfRemoved) {
+                pListRecords->insert(nFirstIndex, nNumberOfInserted - nNumberOfRemoved, XDisasmAbstract::DISASM_RECORD());
+            } else if (nNumberOfInserted < nNumberOfRemoved) {
+                pListRecords->remove(nFirstIndex, nNumberOfRemoved - nNumberOfInserted);
+            }
+
+            std::copy(listNew.constBegin(), listNew.constEnd(), pListRecords->begin() + nFirstIndex);
+
+            pResult->nFirstIndex = nFirstIndex;
+            pResult->nNumberOfRemoved = nNumberOfRemoved;
+            pResult->nNumberOfInserted = nNumberOfInserted;
+            pResult->nStartAddress = nStart;
+            pResult->nEndAddress = sink.m_bIsRealigned ? pListRecords->at(nFirstIndex + nNumberOfInserted).nAddress : (nAddress + nDataSize);
+            pResult->bIsRealigned = sink.m_bIsRealigned;
+
+            if (m_pCheckpoints) {
+                m_pCheckpoints->removeCheckpoints(pResult->nStartAddress, pResult->nEndAddress);
+            }
+
+            bResult = true;
+        }
+    }
+
+    return bResult;
+}
+
+XDisasmAbstract::DISASM_RESULT XDisasmCore::formatRecord(const XDisasmAbstract::DISASM_RECORD &record, char *pData, qint32 nDataSize,
+                                                         const XDisasmAbstract::DISASM_OPTIONS &disasmOptions)
+{
+    // pData points at the bytes of the record. Re-decoding is only meaningful for instruction-set modes;
+    // the structured custom modes (7z/Mach-O streams) keep their text in DISASM_RESULT.
+    return disAsm(pData, nDataSize, record.nAddress, disasmOptions);
+}
+
+XDisasmAbstract::DISASM_RESULT XDisasmCore::formatRecord(const XDisasmAbstract::DISASM_RECORD &record, QIODevice *pDevice, qint64 nOffset,
+                                                         const XDisasmAbstract::DISASM_OPTIONS &disasmOptions)
+{
+    return disAsm(pDevice, nOffset, record.nAddress, disasmOptions);
+}
+
+bool XDisasmCore::mapInput(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, MAPPED_INPUT *pMappedInput)
+{
+    *pMappedInput = MAPPED_INPUT();
+    pMappedInput->nSize = pDevice->size();
+
+    QFile *pFile = qobject_cast<QFile *>(pDevice);
+    QBuffer *pBuffer = qobject_cast<QBuffer *>(pDevice);
+
+    if (pFile && (pMappedInput->nSize > 0)) {
+        pMappedInput->pMapData = pFile->map(0, pMappedInput->nSize);
+
+        if (pMappedInput->pMapData) {
+            pMappedInput->pFile = pFile;
+            pMappedInput->pData = (char *)(pMappedInput->pMapData);
+        }
+    }
+
+    if ((pMappedInput->pData == nullptr) && pBuffer) {
+        // The backends never write through pData
+        pMappedInput->pData = const_cast<char *>(pBuffer->data().constData());
+    }
+
+    if (pMappedInput->pData == nullptr) {
+        pMappedInput->baData = XBinary::read_array(pDevice, 0, pMappedInput->nSize);
+        pMappedInput->nSize = pMappedInput->baData.size();
+        pMappedInput->pData = pMappedInput->baData.data();
+    }
+
+    if (pMemoryMap) {
+        qint32 nNumberOfRecords = pMemoryMap->listRecords.count();
+
+        for (qint32 i = 0; i < nNumberOfRecords; i++) {
+            const XBinary::_MEMORY_RECORD &record = pMemoryMap->listRecords.at(i);
+
+            if ((record.nOffset != -1) && (record.nOffset < pMappedInput->nSize) && (record.nSize > 0)) {
+                MEMORY_REGION region = {};
+                region.nAddress = record.nAddress;
+                region.nOffset = record.nOffset;
+                region.nSize = qMin(record.nSize, pMappedInput->nSize - record.nOffset);
+                region.pData = pMappedInput->pData + record.nOffset;
+
+                pMappedInput->listRegions.append(region);
+            }
+        }
+    } else if (pMappedInput->nSize > 0) {
+        MEMORY_REGION region = {};
+        region.nSize = pMappedInput->nSize;
+        region.pData = pMappedInput->pData;
+
+        pMappedInput->listRegions.append(region);
+    }
+
+    return (pMappedInput->pData != nullptr) || (pMappedInput->nSize == 0);
+}
+
+void XDisasmCore::unmapInput(MAPPED_INPUT *pMappedInput)
+{
+    if (pMappedInput->pFile && pMappedInput->pMapData) {
+        pMappedInput->pFile->unmap(pMappedInput->pMapData);
+    }
+
+    *pMappedInput = MAPPED_INPUT();
+}
+
+bool XDisasmCore::disAsmRegion(const MEMORY_REGION &region, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink,
+                               XBinary::PDSTRUCT *pPdStruct)
+{
+    bool bResult = true;
+    qint64 nCurrentOffset = 0;
+
+    // Regions larger than a qint32 are decoded in windows that overlap by more than one instruction; each
+    // window stops at its nominal end and the next one resumes at the first instruction not yet emitted.
+    while ((nCurrentOffset < region.nSize) && XBinary::isPdStructNotCanceled(pPdStruct)) {
+        qint64 nRemaining = region.nSize - nCurrentOffset;
+        XADDR nWindowAddress = region.nAddress + nCurrentOffset;
+        XADDR nBoundary = (XADDR)-1;
+        bool bIsLast = (nRemaining <= N_REGION_CHUNK_SIZE);
+
+        if (!bIsLast) {
+            nBoundary = nWindowAddress + N_REGION_CHUNK_SIZE;
+        }
+
+        qint32 nWindowSize = (qint32)qMin(nRemaining, N_REGION_CHUNK_SIZE + N_REGION_CHUNK_OVERLAP);
+
+        XDisasmBoundarySink sink(pSink, nBoundary);
+        disAsmStream(region.pData + nCurrentOffset, nWindowSize, nWindowAddress, disasmOptions, &sink, pPdStruct);
+
+        if (sink.m_bIsTargetStop) {
+            bResult = false;
+            break;
+        }
+
+        if (bIsLast || (!sink.m_bIsBoundary)) {
+            break;
+        }
+
+        nCurrentOffset = sink.m_nNextAddress - region.nAddress;
+    }
+
+    return bResult;
+}
+
+void XDisasmCore::disAsmMemoryMap(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink,
+                                  XBinary::PDSTRUCT *pPdStruct)
+{
+    MAPPED_INPUT mappedInput = {};
+
+    if (mapInput(pDevice, pMemoryMap, &mappedInput)) {
+        qint32 nNumberOfRegions = mappedInput.listRegions.count();
+
+        for (qint32 i = 0; (i < nNumberOfRegions) && XBinary::isPdStructNotCanceled(pPdStruct); i++) {
+            if (!disAsmRegion(mappedInput.listRegions.at(i), disasmOptions, pSink, pPdStruct)) {
+                break;
+            }
+        }
+    }
+
+    unmapInput(&mappedInput);
+}
+
+QVector<XDisasmAbstract::DISASM_RECORD> XDisasmCore::disAsmRecordsParallel(char *pData, qint64 nDataSize, XADDR nAddress, qint32 nNumberOfThreads,
+                                                                          XBinary::PDSTRUCT *pPdStruct)
+{
+    QVector<XDisasmAbstract::DISASM_RECORD> listResult;
+
+    if ((!m_pDisasmAbstract) || (nDataSize <= 0)) {
+        return listResult;
+    }
+
+    if (nNumberOfThreads <= 0) {
+        nNumberOfThreads = QThread::idealThreadCount();
+    }
+
+    // A few chunks per thread for load balancing; every chunk window must fit the qint32 size of _disasm
+    qint64 nChunkSize = qMax(nDataSize / (nNumberOfThreads * 4), N_PARALLEL_MIN_CHUNK_SIZE);
+    nChunkSize = qMin(nChunkSize, N_REGION_CHUNK_SIZE);
+
+    qint32 nNumberOfChunks = (qint32)((nDataSize + nChunkSize - 1) / nChunkSize);
+
+    QVector<SWEEP_CHUNK> listChunks(nNumberOfChunks);
+
+    for (qint32 i = 0; i < nNumberOfChunks; i++) {
+        qint64 nChunkOffset = i * nChunkSize;
+
+        SWEEP_CHUNK &chunk = listChunks[i];
+        chunk.pData = pData + nChunkOffset;
+        chunk.nWindowSize = (qint32)qMin(nDataSize - nChunkOffset, nChunkSize + N_REGION_CHUNK_OVERLAP);
+        chunk.nAddress = nAddress + nChunkOffset;
+        chunk.nBoundary = (i == (nNumberOfChunks - 1)) ? ((XADDR)-1) : (chunk.nAddress + nChunkSize);
+        chunk.nNextAddress = 0;
+        chunk.bIsBoundary = false;
+    }
+
+    {
+        QThreadPool threadPool;
+        threadPool.setMaxThreadCount(nNumberOfThreads);
+
+        for (qint32 i = 0; i < nNumberOfChunks; i++) {
+            threadPool.start(new XDisasmChunkTask(this, &(listChunks[i]), pPdStruct));
+        }
+
+        threadPool.waitForDone();
+    }
+
+    // Stitch: chunk i was decoded from its nominal start, but the true stream may enter it mid-instruction
+    // (x86). Take its results from the first speculative start the true stream reaches; on a miss re-decode
+    // sequentially until both streams meet. The output is identical to a sequential sweep.
+    XDisasmAbstract::DISASM_OPTIONS disasmOptions = {};
+    disasmOptions.bLengthOnly = true;
+
+    XADDR nCurrent = nAddress;
+
+    for (qint32 i = 0; (i < nNumberOfChunks) && XBinary::isPdStructNotCanceled(pPdStruct); i++) {
+        SWEEP_CHUNK &chunk = listChunks[i];
+
+        qint32 nIndex = _findRecord(chunk.listRecords, 0, nCurrent);
+
+        if (nIndex == -1) {
+            qint64 nOffset = nCurrent - nAddress;
+            qint64 nWindowSize = nDataSize - nOffset;  // The last chunk has no boundary and runs to the end
+
+            if (chunk.nBoundary != (XADDR)-1) {
+                nWindowSize = qMin(nWindowSize, (qint64)(chunk.nBoundary - nCurrent) + N_REGION_CHUNK_OVERLAP);
+            }
+
+            XDisasmResyncSink sink(&(chunk.listRecords), nCurrent, chunk.nBoundary, &listResult);
+            disAsmStream(pData + nOffset, (qint32)nWindowSize, nCurrent, disasmOptions, &sink, pPdStruct);
+
+            if (sink.m_nSyncIndex != -1) {
+                nIndex = sink.m_nSyncIndex;
+            } else if (sink.m_bIsBoundary) {
+                nCurrent = sink.m_nNextAddress;
+                continue;
+            } else {
+                break;
+            }
+        }
+
+        listResult += chunk.listRecords.mid(nIndex);
+        chunk.listRecords.clear();
+
+        if (!chunk.bIsBoundary) {
+            break;  // The sweep ended inside this chunk
+        }
+
+        nCurrent = chunk.nNextAddress;
+    }
+
+    return listResult;
+}
@@ -26,15 +26,31 @@
 #include "xcolorstring.h"
 #include "xcapstone.h"
 #include "xdisasmabstract.h"
+#include "xmemorymapindex.h"
 #include "Modules/capstone_bridge.h"
 #include "Modules/x7zip_properties.h"
 #include "Modules/xmacho_commands.h"
 
+#include <QAtomicInt>
+#include <QBuffer>
+#include <QCache>
+#include <QFile>
+#include <QMultiHash>
+#include <QMutex>
+#include <QPointer>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QThread>
+#include <QThreadPool>
+
 #ifdef QT_GUI_LIB
 #include <QColor>
 #include <QPainter>
 #endif
 
+class XDisasmCheckpoints;
+class XSignatureBatchTask;
+
 class XDisasmCore : public QObject {
     Q_OBJECT
 public:
@@ -56,6 +72,20 @@ public:
         bool bIsConst;
     };
 
+    // A field of a relative branch ('$' in the text form); a matcher continues at the branch target
+    struct SIGNATURE_REL {
+        qint32 nOffset;
+        qint32 nSize;
+    };
+
+    // Native signature: pattern bytes plus a byte mask. The text form ("8bff55..$$$$") is only produced or
+    // parsed at the edges by signatureToString/stringToSignature.
+    struct SIGNATURE {
+        QByteArray baPattern;  // Wildcard bytes are 0
+        QByteArray baMask;     // 0xFF: the byte must match, 0x00: any byte
+        QVector<SIGNATURE_REL> listRels;
+    };
+
     enum OG {
         OG_UNKNOWN = 0,
         OG_ARROWS,
@@ -83,6 +113,34 @@ public:
         OG_OPCODE_SYSCALL
     };
 
+    struct MEMORY_REGION {
+        XADDR nAddress;
+        qint64 nOffset;
+        qint64 nSize;
+        char *pData;
+    };
+
+    // Input bytes for whole-file passes: a QFile::map view when possible, otherwise the QBuffer data or a single copy
+    struct MAPPED_INPUT {
+        QFile *pFile;
+        uchar *pMapData;
+        QByteArray baData;
+        char *pData;
+        qint64 nSize;
+        QList<MEMORY_REGION> listRegions;  // File-backed records of the memory map, clipped to the input
+    };
+
+    // Changed span of an incremental re-disassembly: records [nFirstIndex, nFirstIndex + nNumberOfInserted) replace
+    // nNumberOfRemoved old ones and cover [nStartAddress, nEndAddress)
+    struct REDISASM_RESULT {
+        qint32 nFirstIndex;
+        qint32 nNumberOfRemoved;
+        qint32 nNumberOfInserted;
+        XADDR nStartAddress;
+        XADDR nEndAddress;
+        bool bIsRealigned;  // false: the new stream never met the old one and runs to the region end
+    };
+
     explicit XDisasmCore(QObject *pParent = nullptr);
     ~XDisasmCore();
 
@@ -90,25 +148,88 @@ public:
     void setSyntax(XBinary::SYNTAX syntax);
     void setOptions(XOptions *pOptions);
 
-    XBinary::DMFAMILY getDisasmFamily();
-    XBinary::DM getDisasmMode();
+    static XDisasmAbstract *createDisasmAbstract(XBinary::DM disasmMode, XBinary::SYNTAX syntax);
+
+    XBinary::DMFAMILY getDisasmFamily() const;
+    XBinary::DM getDisasmMode() const;
 
     XDisasmAbstract::DISASM_RESULT disAsm(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
     XDisasmAbstract::DISASM_RESULT disAsm(QIODevice *pDevice, qint64 nOffset, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
+    // Writes through a device that emits bytesWritten/readyRead (QBuffer, sockets) drop its read and decode caches by themselves;
+    // QFile emits neither, so call this (or notifyBytesChanged) after its bytes were changed
+    void resetReadCache();
+    // Opt-in LRU cache of disAsm(QIODevice *) results, keyed by address; nMaxEntries 0 (default) disables it.
+    // It is dropped on setMode/setSyntax/setOptions and when another device is passed.
+    void setDecodeCacheSize(qint32 nMaxEntries);
+    void clearDecodeCache();
+    void notifyBytesChanged(qint64 nOffset, qint64 nSize);  // Drops cached results that overlap the changed bytes
+    quint64 getDecodeCacheHits() const;
+    quint64 getDecodeCacheMisses() const;
 
+    void setCheckpoints(XDisasmCheckpoints *pCheckpoints);  // disAsmList sweeps from a checkpoint feed it lazily; cleared by setMode/setSyntax; nullptr to detach
     QList<XDisasmAbstract::DISASM_RESULT> disAsmList(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions,
                                                      qint32 nLimit = -1, XBinary::PDSTRUCT *pPdStruct = 0);
+    void disAsmStream(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink,
+                      XBinary::PDSTRUCT *pPdStruct = 0);
+
+    static bool mapInput(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, MAPPED_INPUT *pMappedInput);
+    static void unmapInput(MAPPED_INPUT *pMappedInput);
+    // Returns false if the sink stopped the sweep
+    bool disAsmRegion(const MEMORY_REGION &region, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink, XBinary::PDSTRUCT *pPdStruct = 0);
+    void disAsmMemoryMap(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink,
+                         XBinary::PDSTRUCT *pPdStruct = 0);
 
-    XBinary::SYNTAX getSyntax();
+    QVector<XDisasmAbstract::DISASM_RECORD> disAsmRecords(char *pData, qint32 nDataSize, XADDR nAddress, qint32 nLimit = -1, XBinary::PDSTRUCT *pPdStruct = 0);
+    // Same result as disAsmRecords, decoded in chunks on nNumberOfThreads workers (0: QThread::idealThreadCount)
+    QVector<XDisasmAbstract::DISASM_RECORD> disAsmRecordsParallel(char *pData, qint64 nDataSize, XADDR nAddress, qint32 nNumberOfThreads = 0,
+                                                                  XBinary::PDSTRUCT *pPdStruct = 0);
+    // pListRecords is a disAsmRecords sweep of the region [pData, pData + nDataSize) at nAddress, which now holds the patched bytes.
+    // Only the instructions whose decode could read the patched bytes (from m_nOpcodeSize before the patch start) up to the point
+    // where the stream realigns are decoded again.
+    bool reDisAsmRecords(QVector<XDisasmAbstract::DISASM_RECORD> *pListRecords, char *pData, qint64 nDataSize, XADDR nAddress, qint64 nPatchOffset,
+                         qint64 nPatchSize, REDISASM_RESULT *pResult);
+    XDisasmAbstract::DISASM_RESULT formatRecord(const XDisasmAbstract::DISASM_RECORD &record, char *pData, qint32 nDataSize,
+                                                const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
+    XDisasmAbstract::DISASM_RESULT formatRecord(const XDisasmAbstract::DISASM_RECORD &record, QIODevice *pDevice, qint64 nOffset,
+                                                const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
+
+    XBinary::SYNTAX getSyntax() const;
+
+    // Thread-safe decoding: every call checks a backend out of a pool keyed by (mode, syntax), so one configured
+    // instance can serve a thread pool. The configuration (setMode/setSyntax/setOptions) must not change meanwhile;
+    // a change frees the pooled backends of the old key.
+    XDisasmAbstract::DISASM_RESULT disAsmShared(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions) const;
+    void disAsmStreamShared(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions, XDisasmSink *pSink,
+                            XBinary::PDSTRUCT *pPdStruct = 0) const;
 
     QString getSignature(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, XADDR nAddress, ST signatureType, qint32 nCount);
+    // pListInstructionOffsets, if set, receives the pattern offset of every instruction
+    SIGNATURE getSignatureData(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, XADDR nAddress, ST signatureType, qint32 nCount,
+                               QVector<qint32> *pListInstructionOffsets = nullptr);
+    static QString signatureToString(const SIGNATURE &signature);
+    static bool stringToSignature(const QString &sSignature, SIGNATURE *pSignature);
     QList<XDisasmCore::SIGNATURE_RECORD> getSignatureRecords(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, qint64 nOffset, qint32 nCount, ST signatureType);
+    // Thread-safe variant over mapped bytes: pooled decoders, no read cache, and a shared read-only memory map index
+    // (threads may pass different maps). The mapping, the map and the configuration must not change during the call.
+    QList<XDisasmCore::SIGNATURE_RECORD> getSignatureRecords(const MAPPED_INPUT *pMappedInput, XBinary::_MEMORY_MAP *pMemoryMap, qint64 nOffset, qint32 nCount,
+                                                             ST signatureType);
+    // One getSignatureRecords result per entry offset, in input order, computed on nNumberOfThreads workers (0: QThread::idealThreadCount)
+    QList<QList<XDisasmCore::SIGNATURE_RECORD>> getSignatureRecordsBatch(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, const QList<qint64> &listOffsets,
+                                                                         qint32 nCount, ST signatureType, qint32 nNumberOfThreads = 0,
+                                                                         XBinary::PDSTRUCT *pPdStruct = 0);
     static QString replaceWildChar(const QString &sString, qint32 nOffset, qint32 nSize, QChar cWild);  // Move to XBinary
 
     QString getNumberString(qint64 nValue);
     XColorString convertDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult);
+    // Opt-in LRU cache of convertDisasmResult/convertDisasmRecord, bounded by an estimate of its memory; nMaxBytes 0 (default)
+    // disables it. Entries are keyed by address and checked against the instruction text and the color generation of
+    // rebuildColors. It is not locked: once enabled, both convert functions must be called from one thread (the view's).
+    void setRenderCacheSize(qint32 nMaxBytes);
+    void clearRenderCache();
+    XColorString convertDisasmRecord(const XDisasmAbstract::DISASM_RECORD &record, QIODevice *pDevice, qint64 nOffset,
+                                     const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
 
-    XOptions::COLOR_RECORD getColorRecord(OG og);
+    const XOptions::COLOR_RECORD &getColorRecord(OG og) const;
     static QMap<OG, XOptions::COLOR_RECORD> getColorRecordsMap(XOptions *pOptions, XBinary::DM disasmMode);
     static XOptions::COLOR_RECORD getColorRecord(XOptions *pOptions, XOptions::ID id);
 #ifdef QT_GUI_LIB
@@ -118,17 +239,87 @@ public:
 #endif
     XOptions::COLOR_RECORD getOpcodeColor(quint32 nOpcode);
 
+    friend class XSignatureBatchTask;
+
+private slots:
+    void _onDeviceBytesChanged();  // Both cache layers of the emitting device; the changed range is not known
+
 private:
+    struct COLOR_ENTRY {
+        bool bIsSet;  // sColorMain or sColorBackground is not empty
+        XOptions::COLOR_RECORD colorRecord;
+#ifdef QT_GUI_LIB
+        QColor colorMain;
+        QColor colorBackground;
+#endif
+    };
+
     void rebuildColors();
+    XColorString _convertDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult);
+    OG _getOpcodeOG(quint32 nOpcode) const;
+    OG _getOperandClassOG(quint16 nOperandClass) const;
+#ifdef QT_GUI_LIB
+    void _drawColorText(QPainter *pPainter, const QRectF &rect, const QString &sText, const COLOR_ENTRY &colorEntry);
+#endif
+    quint64 _getPoolKey() const;
+    XDisasmAbstract *_acquireDisasmAbstract(quint64 *pnKey) const;
+    void _releaseDisasmAbstract(XDisasmAbstract *pDisasmAbstract, quint64 nKey) const;
+    void _trimPool();  // Frees the pooled backends of other modes/syntaxes
+    // pMemoryMapIndex nullptr: looked up (and built if needed) for pMemoryMap
+    QList<XDisasmCore::SIGNATURE_RECORD> _getSignatureRecords(QIODevice *pDevice, const MAPPED_INPUT *pMappedInput, XBinary::_MEMORY_MAP *pMemoryMap,
+                                                              qint64 nOffset, qint32 nCount, ST signatureType,
+                                                              QSharedPointer<const XMemoryMapIndex> pMemoryMapIndex = QSharedPointer<const XMemoryMapIndex>());
+    XDisasmAbstract::DISASM_RESULT _disAsmFirst(char *pData, qint32 nDataSize, XADDR nAddress, const XDisasmAbstract::DISASM_OPTIONS &disasmOptions);
+    char *_readCache(QIODevice *pDevice, qint64 nOffset, qint32 nSize, qint32 *pnRealSize);
+    void _dropReadCache();
+    void _watchDevice(QIODevice *pDevice);
+    void _unwatchDevice(QIODevice *pDevice);  // Unless the read or the decode cache still holds it
+    // Index for a map with these records; a different map gets a new instance, the returned one is never modified
+    QSharedPointer<const XMemoryMapIndex> _getMemoryMapIndex(XBinary::_MEMORY_MAP *pMemoryMap);
     XOptions::COLOR_RECORD getOperandColor(const QString &sOperand);
+    XOptions::COLOR_RECORD getOperandColor(const QChar *pData, qint32 nSize);
+    XOptions::COLOR_RECORD getOperandClassColor(quint16 nOperandClass);
 
     XOptions *m_pOptions;
     XBinary::DM m_disasmMode;
     XBinary::DMFAMILY m_disasmFamily;
+    XDisasmAbstract::OPCODECLASS_TABLE m_opcodeClassTable;
     XBinary::SYNTAX m_syntax;
     qint32 m_nOpcodeSize;
     XDisasmAbstract *m_pDisasmAbstract;
-    QMap<OG, XOptions::COLOR_RECORD> m_mapColors;
+    XDisasmCheckpoints *m_pCheckpoints;
+    QVector<COLOR_ENTRY> m_listColors;  // Indexed by OG, see rebuildColors
+    mutable QMutex m_mutexPool;
+    mutable QMultiHash<quint64, XDisasmAbstract *> m_mapPool;
+    QMutex m_mutexMemoryMapIndex;
+    QSharedPointer<const XMemoryMapIndex> m_pMemoryMapIndex;
+    struct DECODECACHE_ENTRY {
+        qint64 nOffset;
+        quint32 nOptionFlags;
+        XDisasmAbstract::DISASM_RESULT disasmResult;
+    };
+
+    QCache<XADDR, DECODECACHE_ENTRY> m_decodeCache;
+    QHash<XADDR, qint64> m_mapDecodeCacheOffsets;  // Offset of every inserted entry; may still list evicted ones
+    struct RENDERCACHE_ENTRY {
+        quint32 nColorGeneration;
+        quint32 nOpcode;
+        qint32 nSize;
+        QString sMnemonic;
+        QString sOperands;
+        XColorString colorString;
+    };
+
+    QCache<XADDR, RENDERCACHE_ENTRY> m_renderCache;
+    quint32 m_nColorGeneration;  // Bumped by rebuildColors (setMode/setSyntax/setOptions)
+    QPointer<QIODevice> m_pDecodeCacheDevice;
+    quint64 m_nDecodeCacheHits;
+    quint64 m_nDecodeCacheMisses;
+    QPointer<QIODevice> m_pReadCacheDevice;
+    qint64 m_nReadCacheOffset;
+    qint32 m_nReadCacheSize;
+    bool m_bReadCacheEnd;  // The device ended inside the cached block
+    QByteArray m_baReadCache;
 #ifdef QT_GUI_LIB
     QTextOption m_qTextOptions;
 #endif
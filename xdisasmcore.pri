@@ -7,14 +7,26 @@ HEADERS += \
     $$PWD/Modules/x7zip_properties.h \
     $$PWD/Modules/xmacho_commands.h \
     $$PWD/Modules/capstone_bridge.h \
+    $$PWD/xmemorymapindex.h \
     $$PWD/xdisasmcore.h \
+    $$PWD/xdisasmcfg.h \
+    $$PWD/xdisasmxrefindex.h \
+    $$PWD/xdisasmcheckpoints.h \
+    $$PWD/xdisasmdatabase.h \
+    $$PWD/xsignaturescanner.h \
     $$PWD/xdisasmabstract.h
 
 SOURCES += \
     $$PWD/Modules/x7zip_properties.cpp \
     $$PWD/Modules/xmacho_commands.cpp \
     $$PWD/Modules/capstone_bridge.cpp \
+    $$PWD/xmemorymapindex.cpp \
     $$PWD/xdisasmcore.cpp \
+    $$PWD/xdisasmcfg.cpp \
+    $$PWD/xdisasmxrefindex.cpp \
+    $$PWD/xdisasmcheckpoints.cpp \
+    $$PWD/xdisasmdatabase.cpp \
+    $$PWD/xsignaturescanner.cpp \
     $$PWD/xdisasmabstract.cpp
 
 !contains(XCONFIG, xbinary) {
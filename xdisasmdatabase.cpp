@@ -0,0 +1,384 @@
+/* Copyright (c) 2025-2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "xdisasmdatabase.h"
+
+const quint32 N_DATABASE_MAGIC = 0x42444458;  // "XDDB"
+const quint32 N_DATABASE_VERSION = 1;
+const qint32 N_DATABASE_HASH_SIZE = 32;  // SHA-256
+const qint64 N_DATABASE_ALIGNMENT = 8;
+const qint64 N_DATABASE_COPY_CHUNK = 0x10000;  // Elements per zeroed copy buffer
+
+Q_STATIC_ASSERT(sizeof(XADDR) == 8);
+
+// Copies nCount elements field by field into a zeroed buffer, so struct padding never reaches the file
+typedef void (*DATABASE_COPY)(char *pDest, const char *pSource, qint64 nCount);
+
+// One section to be written: nCount elements of nElementSize bytes at pData; pCopy is nullptr for padding-free types
+struct DATABASE_SOURCE {
+    quint32 nType;
+    quint32 nElementSize;
+    const char *pData;
+    qint64 nCount;
+    DATABASE_COPY pCopy;
+};
+
+static void _copyRecords(char *pDest, const char *pSource, qint64 nCount)
+{
+    const XDisasmAbstract::DISASM_RECORD *pRecords = (const XDisasmAbstract::DISASM_RECORD *)pSource;
+    XDisasmAbstract::DISASM_RECORD *pResult = (XDisasmAbstract::DISASM_RECORD *)pDest;
+
+    for (qint64 i = 0; i < nCount; i++) {
+        pResult[i].nAddress = pRecords[i].nAddress;
+        pResult[i].nXrefTo = pRecords[i].nXrefTo;
+        pResult[i].nSize = pRecords[i].nSize;
+        pResult[i].nOpcode = pRecords[i].nOpcode;
+        pResult[i].nFlags = pRecords[i].nFlags;
+        pResult[i].nRelType = pRecords[i].nRelType;
+        pResult[i].nMemType = pRecords[i].nMemType;
+        pResult[i].nMemorySize = pRecords[i].nMemorySize;
+        pResult[i].nDispOffset = pRecords[i].nDispOffset;
+        pResult[i].nDispSize = pRecords[i].nDispSize;
+        pResult[i].nImmOffset = pRecords[i].nImmOffset;
+        pResult[i].nImmSize = pRecords[i].nImmSize;
+    }
+}
+
+static void _copyBlocks(char *pDest, const char *pSource, qint64 nCount)
+{
+    const XDisasmCFG::BLOCK *pBlocks = (const XDisasmCFG::BLOCK *)pSource;
+    XDisasmCFG::BLOCK *pResult = (XDisasmCFG::BLOCK *)pDest;
+
+    for (qint64 i = 0; i < nCount; i++) {
+        pResult[i].nAddress = pBlocks[i].nAddress;
+        pResult[i].nFunction = pBlocks[i].nFunction;
+        pResult[i].nSize = pBlocks[i].nSize;
+        pResult[i].nFirstRecord = pBlocks[i].nFirstRecord;
+        pResult[i].nNumberOfRecords = pBlocks[i].nNumberOfRecords;
+        pResult[i].nFirstEdge = pBlocks[i].nFirstEdge;
+        pResult[i].nNumberOfEdges = pBlocks[i].nNumberOfEdges;
+    }
+}
+
+static void _copyEdges(char *pDest, const char *pSource, qint64 nCount)
+{
+    const XDisasmCFG::EDGE *pEdges = (const XDisasmCFG::EDGE *)pSource;
+    XDisasmCFG::EDGE *pResult = (XDisasmCFG::EDGE *)pDest;
+
+    for (qint64 i = 0; i < nCount; i++) {
+        pResult[i].nFrom = pEdges[i].nFrom;
+        pResult[i].nTo = pEdges[i].nTo;
+        pResult[i].edgeType = pEdges[i].edgeType;
+    }
+}
+
+static void _copyXrefs(char *pDest, const char *pSource, qint64 nCount)
+{
+    const XDisasmXrefIndex::XREF *pXrefs = (const XDisasmXrefIndex::XREF *)pSource;
+    XDisasmXrefIndex::XREF *pResult = (XDisasmXrefIndex::XREF *)pDest;
+
+    for (qint64 i = 0; i < nCount; i++) {
+        pResult[i].nFrom = pXrefs[i].nFrom;
+        pResult[i].nTo = pXrefs[i].nTo;
+        pResult[i].nRelType = pXrefs[i].nRelType;
+        pResult[i].nMemType = pXrefs[i].nMemType;
+    }
+}
+
+static bool _writeSource(QIODevice *pDevice, const DATABASE_SOURCE &source)
+{
+    bool bResult = true;
+
+    if (source.pCopy) {
+        QByteArray baBuffer;
+
+        for (qint64 nIndex = 0; bResult && (nIndex < source.nCount); nIndex += N_DATABASE_COPY_CHUNK) {
+            qint64 nCount = qMin(source.nCount - nIndex, N_DATABASE_COPY_CHUNK);
+            qint64 nSize = nCount * source.nElementSize;
+
+            baBuffer.fill(0, (qint32)nSize);
+            source.pCopy(baBuffer.data(), source.pData + nIndex * source.nElementSize, nCount);
+
+            bResult = (pDevice->write(baBuffer.constData(), nSize) == nSize);
+        }
+    } else {
+        qint64 nDataSize = source.nCount * source.nElementSize;
+
+        bResult = (pDevice->write(source.pData, nDataSize) == nDataSize);
+    }
+
+    return bResult;
+}
+
+static qint64 _align(qint64 nValue)
+{
+    return (nValue + N_DATABASE_ALIGNMENT - 1) & ~(N_DATABASE_ALIGNMENT - 1);
+}
+
+XDisasmDatabase::XDisasmDatabase(QObject *pParent) : QObject(pParent)
+{
+    m_pData = nullptr;
+    m_nSize = 0;
+    m_pSections = nullptr;
+    m_nNumberOfSections = 0;
+}
+
+XDisasmDatabase::~XDisasmDatabase()
+{
+    close();
+}
+
+QByteArray XDisasmDatabase::getContentHash(QIODevice *pDevice)
+{
+    QByteArray baResult;
+
+    XDisasmCore::MAPPED_INPUT mappedInput = {};
+
+    if (XDisasmCore::mapInput(pDevice, nullptr, &mappedInput)) {
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+
+        // addData takes an int size
+        for (qint64 nOffset = 0; nOffset < mappedInput.nSize; nOffset += 0x40000000) {
+            hash.addData(mappedInput.pData + nOffset, (int)qMin(mappedInput.nSize - nOffset, (qint64)0x40000000));
+        }
+
+        baResult = hash.result();
+    }
+
+    XDisasmCore::unmapInput(&mappedInput);
+
+    return baResult;
+}
+
+bool XDisasmDatabase::write(QIODevice *pDevice, const QByteArray &baContentHash, XBinary::DM disasmMode, XBinary::SYNTAX syntax, const DATA &data)
+{
+    bool bResult = false;
+
+    if (baContentHash.size() == N_DATABASE_HASH_SIZE) {
+        QList<DATABASE_SOURCE> listSources;
+
+        if (data.pListRecords) {
+            DATABASE_SOURCE source = {SECTION_RECORDS, sizeof(XDisasmAbstract::DISASM_RECORD), (const char *)data.pListRecords->constData(),
+                                      data.pListRecords->count(), _copyRecords};
+            listSources.append(source);
+        }
+
+        if (data.pCheckpoints) {
+            const QVector<XADDR> &listCheckpoints = data.pCheckpoints->getCheckpoints();
+            DATABASE_SOURCE source = {SECTION_CHECKPOINTS, sizeof(XADDR), (const char *)listCheckpoints.constData(), listCheckpoints.count(), nullptr};
+            listSources.append(source);
+        }
+
+        if (data.pGraph) {
+            DATABASE_SOURCE sourceBlocks = {SECTION_BLOCKS, sizeof(XDisasmCFG::BLOCK), (const char *)data.pGraph->listBlocks.constData(),
+                                            data.pGraph->listBlocks.count(), _copyBlocks};
+            DATABASE_SOURCE sourceEdges = {SECTION_EDGES, sizeof(XDisasmCFG::EDGE), (const char *)data.pGraph->listEdges.constData(),
+                                           data.pGraph->listEdges.count(), _copyEdges};
+            DATABASE_SOURCE sourceFunctions = {SECTION_FUNCTIONS, sizeof(XADDR), (const char *)data.pGraph->listFunctions.constData(),
+                                               data.pGraph->listFunctions.count(), nullptr};
+            listSources.append(sourceBlocks);
+            listSources.append(sourceEdges);
+            listSources.append(sourceFunctions);
+
+            if (!data.pListRecords) {
+                DATABASE_SOURCE sourceRecords = {SECTION_RECORDS, sizeof(XDisasmAbstract::DISASM_RECORD), (const char *)data.pGraph->listRecords.constData(),
+                                                 data.pGraph->listRecords.count(), _copyRecords};
+                listSources.append(sourceRecords);
+            }
+        }
+
+        if (data.pXrefIndex) {
+            const QVector<XDisasmXrefIndex::XREF> &listByTo = data.pXrefIndex->getXrefsByTo();
+            const QVector<XDisasmXrefIndex::XREF> &listByFrom = data.pXrefIndex->getXrefsByFrom();
+            DATABASE_SOURCE sourceByTo = {SECTION_XREFS_BY_TO, sizeof(XDisasmXrefIndex::XREF), (const char *)listByTo.constData(), listByTo.count(),
+                                          _copyXrefs};
+            DATABASE_SOURCE sourceByFrom = {SECTION_XREFS_BY_FROM, sizeof(XDisasmXrefIndex::XREF), (const char *)listByFrom.constData(),
+                                            listByFrom.count(), _copyXrefs};
+            listSources.append(sourceByTo);
+            listSources.append(sourceByFrom);
+        }
+
+        qint32 nNumberOfSections = listSources.count();
+
+        HEADER header = {};
+        header.nMagic = N_DATABASE_MAGIC;
+        header.nVersion = N_DATABASE_VERSION;
+        header.nMode = (quint32)disasmMode;
+        header.nSyntax = (quint32)syntax;
+        header.nNumberOfSections = nNumberOfSections;
+        memcpy(header.contentHash, baContentHash.constData(), N_DATABASE_HASH_SIZE);
+
+        QVector<SECTION_HEADER> listSectionHeaders(nNumberOfSections);
+        qint64 nOffset = _align(sizeof(HEADER) + nNumberOfSections * sizeof(SECTION_HEADER));
+
+        for (qint32 i = 0; i < nNumberOfSections; i++) {
+            listSectionHeaders[i].nType = listSources.at(i).nType;
+            listSectionHeaders[i].nElementSize = listSources.at(i).nElementSize;
+            listSectionHeaders[i].nOffset = nOffset;
+            listSectionHeaders[i].nCount = listSources.at(i).nCount;
+
+            nOffset = _align(nOffset + listSources.at(i).nCount * listSources.at(i).nElementSize);
+        }
+
+        bResult = (pDevice->write((const char *)&header, sizeof(HEADER)) == sizeof(HEADER));
+
+        if (bResult && nNumberOfSections) {
+            qint64 nTableSize = nNumberOfSections * sizeof(SECTION_HEADER);
+            bResult = (pDevice->write((const char *)listSectionHeaders.constData(), nTableSize) == nTableSize);
+        }
+
+        qint64 nCurrentOffset = sizeof(HEADER) + nNumberOfSections * sizeof(SECTION_HEADER);
+        const char padding[N_DATABASE_ALIGNMENT] = {};
+
+        for (qint32 i = 0; bResult && (i < nNumberOfSections); i++) {
+            qint64 nPaddingSize = listSectionHeaders.at(i).nOffset - nCurrentOffset;
+            qint64 nDataSize = listSources.at(i).nCount * listSources.at(i).nElementSize;
+
+            bResult = (pDevice->write(padding, nPaddingSize) == nPaddingSize);
+
+            if (bResult && nDataSize) {
+                bResult = _writeSource(pDevice, listSources.at(i));
+            }
+
+            nCurrentOffset = listSectionHeaders.at(i).nOffset + nDataSize;
+        }
+    }
+
+    return bResult;
+}
+
+bool XDisasmDatabase::open(const QString &sFileName, const QByteArray &baContentHash, XBinary::DM disasmMode, XBinary::SYNTAX syntax)
+{
+    close();
+
+    bool bResult = false;
+
+    m_file.setFileName(sFileName);
+
+    if ((baContentHash.size() == N_DATABASE_HASH_SIZE) && m_file.open(QIODevice::ReadOnly)) {
+        m_nSize = m_file.size();
+
+        if (m_nSize >= (qint64)sizeof(HEADER)) {
+            m_pData = m_file.map(0, m_nSize);
+        }
+
+        if (m_pData) {
+            const HEADER *pHeader = (const HEADER *)m_pData;
+
+            bool bIsValid = (pHeader->nMagic == N_DATABASE_MAGIC) && (pHeader->nVersion == N_DATABASE_VERSION) && (pHeader->nMode == (quint32)disasmMode) &&
+                            (pHeader->nSyntax == (quint32)syntax) && (memcmp(pHeader->contentHash, baContentHash.constData(), N_DATABASE_HASH_SIZE) == 0) &&
+                            (pHeader->nNumberOfSections <= (quint64)((m_nSize - sizeof(HEADER)) / sizeof(SECTION_HEADER)));
+
+            if (bIsValid) {
+                m_pSections = (const SECTION_HEADER *)(m_pData + sizeof(HEADER));
+                m_nNumberOfSections = (qint32)pHeader->nNumberOfSections;
+
+                // Every section must lie inside the file; after this check the getters do no validation
+                for (qint32 i = 0; bIsValid && (i < m_nNumberOfSections); i++) {
+                    const SECTION_HEADER &section = m_pSections[i];
+
+                    bIsValid = (section.nElementSize > 0) && ((section.nOffset % N_DATABASE_ALIGNMENT) == 0) && (section.nOffset <= (quint64)m_nSize) &&
+                               (section.nCount <= (((quint64)m_nSize - section.nOffset) / section.nElementSize));
+                }
+            }
+
+            bResult = bIsValid;
+        }
+    }
+
+    if (!bResult) {
+        close();
+    }
+
+    return bResult;
+}
+
+void XDisasmDatabase::close()
+{
+    if (m_pData) {
+        m_file.unmap(m_pData);
+        m_pData = nullptr;
+    }
+
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+
+    m_nSize = 0;
+    m_pSections = nullptr;
+    m_nNumberOfSections = 0;
+}
+
+bool XDisasmDatabase::isOpen() const
+{
+    return (m_pData != nullptr);
+}
+
+const char *XDisasmDatabase::_getSection(SECTION section, qint32 nElementSize, qint64 *pnCount) const
+{
+    const char *pResult = nullptr;
+    *pnCount = 0;
+
+    for (qint32 i = 0; i < m_nNumberOfSections; i++) {
+        if ((m_pSections[i].nType == section) && (m_pSections[i].nElementSize == (quint32)nElementSize)) {
+            pResult = (const char *)(m_pData + m_pSections[i].nOffset);
+            *pnCount = (qint64)m_pSections[i].nCount;
+            break;
+        }
+    }
+
+    return pResult;
+}
+
+const XDisasmAbstract::DISASM_RECORD *XDisasmDatabase::getRecords(qint64 *pnCount) const
+{
+    return (const XDisasmAbstract::DISASM_RECORD *)_getSection(SECTION_RECORDS, sizeof(XDisasmAbstract::DISASM_RECORD), pnCount);
+}
+
+const XADDR *XDisasmDatabase::getCheckpoints(qint64 *pnCount) const
+{
+    return (const XADDR *)_getSection(SECTION_CHECKPOINTS, sizeof(XADDR), pnCount);
+}
+
+const XDisasmCFG::BLOCK *XDisasmDatabase::getBlocks(qint64 *pnCount) const
+{
+    return (const XDisasmCFG::BLOCK *)_getSection(SECTION_BLOCKS, sizeof(XDisasmCFG::BLOCK), pnCount);
+}
+
+const XDisasmCFG::EDGE *XDisasmDatabase::getEdges(qint64 *pnCount) const
+{
+    return (const XDisasmCFG::EDGE *)_getSection(SECTION_EDGES, sizeof(XDisasmCFG::EDGE), pnCount);
+}
+
+const XADDR *XDisasmDatabase::getFunctions(qint64 *pnCount) const
+{
+    return (const XADDR *)_getSection(SECTION_FUNCTIONS, sizeof(XADDR), pnCount);
+}
+
+const XDisasmXrefIndex::XREF *XDisasmDatabase::getXrefsByTo(qint64 *pnCount) const
+{
+    return (const XDisasmXrefIndex::XREF *)_getSection(SECTION_XREFS_BY_TO, sizeof(XDisasmXrefIndex::XREF), pnCount);
+}
+
+const XDisasmXrefIndex::XREF *XDisasmDatabase::getXrefsByFrom(qint64 *pnCount) const
+{
+    return (const XDisasmXrefIndex::XREF *)_getSection(SECTION_XREFS_BY_FROM, sizeof(XDisasmXrefIndex::XREF), pnCount);
+}
@@ -0,0 +1,102 @@
+/* Copyright (c) 2025-2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef XDISASMDATABASE_H
+#define XDISASMDATABASE_H
+
+#include "xdisasmcfg.h"
+#include "xdisasmcheckpoints.h"
+#include "xdisasmxrefindex.h"
+
+#include <QCryptographicHash>
+
+// Versioned on-disk form of the analysis results. Every kind of data is one contiguous array of the in-memory
+// struct, 8-byte aligned, so a database is reopened with QFile::map and used in place without parsing. Files are
+// keyed by a content hash of the input plus mode and syntax; a stale or damaged file simply fails to open.
+// The arrays are in host byte order.
+class XDisasmDatabase : public QObject {
+    Q_OBJECT
+
+public:
+    enum SECTION : quint32 {
+        SECTION_RECORDS = 1,
+        SECTION_CHECKPOINTS,
+        SECTION_BLOCKS,
+        SECTION_EDGES,
+        SECTION_FUNCTIONS,
+        SECTION_XREFS_BY_TO,
+        SECTION_XREFS_BY_FROM
+    };
+
+    // Sources for write(); null members are left out
+    struct DATA {
+        const QVector<XDisasmAbstract::DISASM_RECORD> *pListRecords;
+        const XDisasmCheckpoints *pCheckpoints;
+        const XDisasmCFG::GRAPH *pGraph;
+        const XDisasmXrefIndex *pXrefIndex;  // Must be finalized
+    };
+
+    explicit XDisasmDatabase(QObject *pParent = nullptr);
+    ~XDisasmDatabase();
+
+    static QByteArray getContentHash(QIODevice *pDevice);
+    static bool write(QIODevice *pDevice, const QByteArray &baContentHash, XBinary::DM disasmMode, XBinary::SYNTAX syntax, const DATA &data);
+
+    bool open(const QString &sFileName, const QByteArray &baContentHash, XBinary::DM disasmMode, XBinary::SYNTAX syntax);
+    void close();
+    bool isOpen() const;
+
+    // Views into the mapped file, valid until close(); nullptr and *pnCount = 0 if the section is absent
+    const XDisasmAbstract::DISASM_RECORD *getRecords(qint64 *pnCount) const;
+    const XADDR *getCheckpoints(qint64 *pnCount) const;
+    const XDisasmCFG::BLOCK *getBlocks(qint64 *pnCount) const;
+    const XDisasmCFG::EDGE *getEdges(qint64 *pnCount) const;
+    const XADDR *getFunctions(qint64 *pnCount) const;
+    const XDisasmXrefIndex::XREF *getXrefsByTo(qint64 *pnCount) const;
+    const XDisasmXrefIndex::XREF *getXrefsByFrom(qint64 *pnCount) const;
+
+private:
+    struct HEADER {
+        quint32 nMagic;
+        quint32 nVersion;
+        quint32 nMode;
+        quint32 nSyntax;
+        quint8 contentHash[32];
+        quint64 nNumberOfSections;
+    };
+
+    struct SECTION_HEADER {
+        quint32 nType;
+        quint32 nElementSize;  // Guards against a struct layout change
+        quint64 nOffset;
+        quint64 nCount;
+    };
+
+    const char *_getSection(SECTION section, qint32 nElementSize, qint64 *pnCount) const;
+
+    QFile m_file;
+    uchar *m_pData;
+    qint64 m_nSize;
+    const SECTION_HEADER *m_pSections;
+    qint32 m_nNumberOfSections;
+};
+
+#endif  // XDISASMDATABASE_H
@@ -0,0 +1,205 @@
+/* Copyright (c) 2025-2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "xdisasmxrefindex.h"
+
+#include <algorithm>
+
+static bool _compareTo(const XDisasmXrefIndex::XREF &a, const XDisasmXrefIndex::XREF &b)
+{
+    return (a.nTo < b.nTo) || ((a.nTo == b.nTo) && (a.nFrom < b.nFrom));
+}
+
+static bool _compareFrom(const XDisasmXrefIndex::XREF &a, const XDisasmXrefIndex::XREF &b)
+{
+    return (a.nFrom < b.nFrom) || ((a.nFrom == b.nFrom) && (a.nTo < b.nTo));
+}
+
+XDisasmXrefIndex::XDisasmXrefIndex(QObject *pParent) : QObject(pParent)
+{
+}
+
+void XDisasmXrefIndex::clear()
+{
+    m_listXrefsByTo.clear();
+    m_listXrefsByFrom.clear();
+}
+
+void XDisasmXrefIndex::addXref(XADDR nFrom, XADDR nTo, quint8 nRelType, quint8 nMemType)
+{
+    XREF xref = {};
+    xref.nFrom = nFrom;
+    xref.nTo = nTo;
+    xref.nRelType = nRelType;
+    xref.nMemType = nMemType;
+
+    m_listXrefsByTo.append(xref);
+}
+
+void XDisasmXrefIndex::addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult)
+{
+    if (disasmResult.bIsValid) {
+        if (disasmResult.relType != XDisasmAbstract::RELTYPE_NONE) {
+            addXref(disasmResult.nAddress, disasmResult.nXrefToRelative, (quint8)disasmResult.relType, XDisasmAbstract::MEMTYPE_NONE);
+        }
+
+        if (disasmResult.memType != XDisasmAbstract::MEMTYPE_NONE) {
+            addXref(disasmResult.nAddress, disasmResult.nXrefToMemory, XDisasmAbstract::RELTYPE_NONE, (quint8)disasmResult.memType);
+        }
+    }
+}
+
+void XDisasmXrefIndex::addRecord(const XDisasmAbstract::DISASM_RECORD &record)
+{
+    if (record.nFlags & XDisasmAbstract::RECFLAG_VALID) {
+        if (record.nRelType != XDisasmAbstract::RELTYPE_NONE) {
+            addXref(record.nAddress, record.nXrefTo, record.nRelType, XDisasmAbstract::MEMTYPE_NONE);
+        } else if (record.nMemType != XDisasmAbstract::MEMTYPE_NONE) {
+            addXref(record.nAddress, record.nXrefTo, XDisasmAbstract::RELTYPE_NONE, record.nMemType);
+        }
+    }
+}
+
+void XDisasmXrefIndex::addRecords(const QVector<XDisasmAbstract::DISASM_RECORD> &listRecords)
+{
+    qint32 nNumberOfRecords = listRecords.count();
+
+    m_listXrefsByTo.reserve(m_listXrefsByTo.count() + nNumberOfRecords);
+
+    for (qint32 i = 0; i < nNumberOfRecords; i++) {
+        addRecord(listRecords.at(i));
+    }
+}
+
+void XDisasmXrefIndex::finalize()
+{
+    // New xrefs are appended to m_listXrefsByTo; the by-source copy is rebuilt from it
+    std::sort(m_listXrefsByTo.begin(), m_listXrefsByTo.end(), _compareTo);
+
+    m_listXrefsByFrom = m_listXrefsByTo;
+    std::sort(m_listXrefsByFrom.begin(), m_listXrefsByFrom.end(), _compareFrom);
+}
+
+qint32 XDisasmXrefIndex::getNumberOfXrefs() const
+{
+    return m_listXrefsByTo.count();
+}
+
+qint32 XDisasmXrefIndex::lowerBoundTo(XADDR nAddress) const
+{
+    XREF xref = {};
+    xref.nTo = nAddress;
+
+    return (qint32)(std::lower_bound(m_listXrefsByTo.constBegin(), m_listXrefsByTo.constEnd(), xref, _compareTo) - m_listXrefsByTo.constBegin());
+}
+
+qint32 XDisasmXrefIndex::lowerBoundFrom(XADDR nAddress) const
+{
+    XREF xref = {};
+    xref.nFrom = nAddress;
+
+    return (qint32)(std::lower_bound(m_listXrefsByFrom.constBegin(), m_listXrefsByFrom.constEnd(), xref, _compareFrom) - m_listXrefsByFrom.constBegin());
+}
+
+const QVector<XDisasmXrefIndex::XREF> &XDisasmXrefIndex::getXrefsByTo() const
+{
+    return m_listXrefsByTo;
+}
+
+const QVector<XDisasmXrefIndex::XREF> &XDisasmXrefIndex::getXrefsByFrom() const
+{
+    return m_listXrefsByFrom;
+}
+
+qint32 XDisasmXrefIndex::countXrefsTo(XADDR nStart, XADDR nEnd) const
+{
+    qint32 nResult = 0;
+
+    if (nStart < nEnd) {
+        nResult = lowerBoundTo(nEnd) - lowerBoundTo(nStart);
+    }
+
+    return nResult;
+}
+
+bool XDisasmXrefIndex::isXrefTarget(XADDR nAddress) const
+{
+    qint32 nIndex = lowerBoundTo(nAddress);
+
+    return (nIndex < m_listXrefsByTo.count()) && (m_listXrefsByTo.at(nIndex).nTo == nAddress);
+}
+
+QVector<XDisasmXrefIndex::XREF> XDisasmXrefIndex::getXrefsTo(XADDR nAddress) const
+{
+    return getXrefsTo(nAddress, nAddress + 1);
+}
+
+QVector<XDisasmXrefIndex::XREF> XDisasmXrefIndex::getXrefsTo(XADDR nStart, XADDR nEnd) const
+{
+    QVector<XREF> listResult;
+
+    if (nStart < nEnd) {
+        qint32 nIndex = lowerBoundTo(nStart);
+        qint32 nEndIndex = lowerBoundTo(nEnd);
+
+        listResult = m_listXrefsByTo.mid(nIndex, nEndIndex - nIndex);
+    }
+
+    return listResult;
+}
+
+QVector<XDisasmXrefIndex::XREF> XDisasmXrefIndex::getXrefsFrom(XADDR nAddress) const
+{
+    return getXrefsFrom(nAddress, nAddress + 1);
+}
+
+QVector<XDisasmXrefIndex::XREF> XDisasmXrefIndex::getXrefsFrom(XADDR nStart, XADDR nEnd) const
+{
+    QVector<XREF> listResult;
+
+    if (nStart < nEnd) {
+        qint32 nIndex = lowerBoundFrom(nStart);
+        qint32 nEndIndex = lowerBoundFrom(nEnd);
+
+        listResult = m_listXrefsByFrom.mid(nIndex, nEndIndex - nIndex);
+    }
+
+    return listResult;
+}
+
+XDisasmXrefSink::XDisasmXrefSink(XDisasmXrefIndex *pXrefIndex, XDisasmSink *pTarget)
+{
+    m_pXrefIndex = pXrefIndex;
+    m_pTarget = pTarget;
+}
+
+bool XDisasmXrefSink::addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult)
+{
+    bool bResult = true;
+
+    m_pXrefIndex->addDisasmResult(disasmResult);
+
+    if (m_pTarget) {
+        bResult = m_pTarget->addDisasmResult(disasmResult);
+    }
+
+    return bResult;
+}
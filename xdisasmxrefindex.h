@@ -0,0 +1,80 @@
+/* Copyright (c) 2025-2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef XDISASMXREFINDEX_H
+#define XDISASMXREFINDEX_H
+
+#include "xdisasmabstract.h"
+
+// Code and data cross references collected while a sweep or CFG pass runs. After finalize() the xrefs are held
+// in two flat arrays, one sorted by target and one by source, and every query is a binary search.
+class XDisasmXrefIndex : public QObject {
+    Q_OBJECT
+
+public:
+    struct XREF {
+        XADDR nFrom;
+        XADDR nTo;
+        quint8 nRelType;  // XDisasmAbstract::RELTYPE, RELTYPE_NONE for data xrefs
+        quint8 nMemType;  // XDisasmAbstract::MEMTYPE, MEMTYPE_NONE for code xrefs
+    };
+
+    explicit XDisasmXrefIndex(QObject *pParent = nullptr);
+
+    void clear();
+    void addXref(XADDR nFrom, XADDR nTo, quint8 nRelType, quint8 nMemType);
+    void addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult);  // Both the relative and the memory xref
+    void addRecord(const XDisasmAbstract::DISASM_RECORD &record);             // The single xref a record keeps
+    void addRecords(const QVector<XDisasmAbstract::DISASM_RECORD> &listRecords);
+    void finalize();  // Sorts the added xrefs; the queries below require it
+
+    qint32 getNumberOfXrefs() const;
+    // Ranges are [nStart, nEnd); the index helpers return the first position in getXrefsByTo()/getXrefsByFrom()
+    // so hot loops can walk the arrays without allocating.
+    qint32 lowerBoundTo(XADDR nAddress) const;
+    qint32 lowerBoundFrom(XADDR nAddress) const;
+    const QVector<XREF> &getXrefsByTo() const;
+    const QVector<XREF> &getXrefsByFrom() const;
+    qint32 countXrefsTo(XADDR nStart, XADDR nEnd) const;
+    bool isXrefTarget(XADDR nAddress) const;
+    QVector<XREF> getXrefsTo(XADDR nAddress) const;
+    QVector<XREF> getXrefsTo(XADDR nStart, XADDR nEnd) const;
+    QVector<XREF> getXrefsFrom(XADDR nAddress) const;
+    QVector<XREF> getXrefsFrom(XADDR nStart, XADDR nEnd) const;
+
+private:
+    QVector<XREF> m_listXrefsByTo;
+    QVector<XREF> m_listXrefsByFrom;
+};
+
+// Records the xrefs of every result and forwards it to pTarget, if any
+class XDisasmXrefSink : public XDisasmSink {
+public:
+    explicit XDisasmXrefSink(XDisasmXrefIndex *pXrefIndex, XDisasmSink *pTarget = nullptr);
+
+    virtual bool addDisasmResult(const XDisasmAbstract::DISASM_RESULT &disasmResult);
+
+private:
+    XDisasmXrefIndex *m_pXrefIndex;
+    XDisasmSink *m_pTarget;
+};
+
+#endif  // XDISASMXREFINDEX_H
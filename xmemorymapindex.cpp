@@ -0,0 +1,223 @@
+/* Copyright (c) 2025-2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "xmemorymapindex.h"
+
+#include <algorithm>
+
+XMemoryMapIndex::XMemoryMapIndex()
+{
+    m_nBinarySize = -1;
+}
+
+void XMemoryMapIndex::build(const XBinary::_MEMORY_MAP *pMemoryMap)
+{
+    QList<INTERVAL> listAddresses;
+    QList<INTERVAL> listOffsets;
+
+    qint32 nNumberOfRecords = pMemoryMap->listRecords.count();
+
+    m_listRecordKeys.resize(nNumberOfRecords);
+
+    for (qint32 i = 0; i < nNumberOfRecords; i++) {
+        const XBinary::_MEMORY_RECORD &record = pMemoryMap->listRecords.at(i);
+
+        m_listRecordKeys[i].nAddress = record.nAddress;
+        m_listRecordKeys[i].nOffset = record.nOffset;
+        m_listRecordKeys[i].nSize = record.nSize;
+
+        if ((record.nSize > 0) && (record.nOffset != -1) && (record.nAddress != (XADDR)-1)) {
+            INTERVAL intervalAddress = {record.nAddress, record.nAddress + record.nSize, (quint64)record.nOffset};
+            INTERVAL intervalOffset = {(quint64)record.nOffset, (quint64)(record.nOffset + record.nSize), record.nAddress};
+
+            listAddresses.append(intervalAddress);
+            listOffsets.append(intervalOffset);
+        }
+    }
+
+    m_listAddressIntervals = _buildIntervals(listAddresses);
+    m_listOffsetIntervals = _buildIntervals(listOffsets);
+    m_nBinarySize = pMemoryMap->nBinarySize;
+}
+
+bool XMemoryMapIndex::isBuiltFor(const XBinary::_MEMORY_MAP *pMemoryMap) const
+{
+    // By content: the same map object may be refilled (image base change, a map on the stack at the same address)
+    bool bResult = (m_nBinarySize == pMemoryMap->nBinarySize) && (m_listRecordKeys.count() == pMemoryMap->listRecords.count());
+
+    qint32 nNumberOfRecords = m_listRecordKeys.count();
+
+    for (qint32 i = 0; bResult && (i < nNumberOfRecords); i++) {
+        const XBinary::_MEMORY_RECORD &record = pMemoryMap->listRecords.at(i);
+        const RECORD_KEY &recordKey = m_listRecordKeys.at(i);
+
+        bResult = (recordKey.nAddress == record.nAddress) && (recordKey.nOffset == record.nOffset) && (recordKey.nSize == record.nSize);
+    }
+
+    return bResult;
+}
+
+XMemoryMapIndex::CURSOR XMemoryMapIndex::getCursor()
+{
+    CURSOR result = {-1, -1};
+
+    return result;
+}
+
+QVector<XMemoryMapIndex::INTERVAL> XMemoryMapIndex::_buildIntervals(const QList<INTERVAL> &listOrdered)
+{
+    // Cut at every boundary; each elementary piece belongs to the first interval (in record order) covering it
+    QVector<quint64> listBounds;
+    qint32 nNumberOfIntervals = listOrdered.count();
+
+    for (qint32 i = 0; i < nNumberOfIntervals; i++) {
+        listBounds.append(listOrdered.at(i).nStart);
+        listBounds.append(listOrdered.at(i).nEnd);
+    }
+
+    std::sort(listBounds.begin(), listBounds.end());
+    listBounds.erase(std::unique(listBounds.begin(), listBounds.end()), listBounds.end());
+
+    QVector<INTERVAL> listResult;
+    qint32 nLastOwner = -1;
+    qint32 nNumberOfBounds = listBounds.count();
+
+    for (qint32 i = 0; (i + 1) < nNumberOfBounds; i++) {
+        quint64 nStart = listBounds.at(i);
+        quint64 nEnd = listBounds.at(i + 1);
+        qint32 nOwner = -1;
+
+        for (qint32 j = 0; j < nNumberOfIntervals; j++) {
+            if ((listOrdered.at(j).nStart <= nStart) && (nEnd <= listOrdered.at(j).nEnd)) {
+                nOwner = j;
+                break;
+            }
+        }
+
+        if (nOwner != -1) {
+            if ((nOwner == nLastOwner) && (listResult.last().nEnd == nStart)) {
+                listResult.last().nEnd = nEnd;
+            } else {
+                INTERVAL interval = {nStart, nEnd, listOrdered.at(nOwner).nTarget + (nStart - listOrdered.at(nOwner).nStart)};
+                listResult.append(interval);
+            }
+        }
+
+        nLastOwner = nOwner;
+    }
+
+    return listResult;
+}
+
+qint32 XMemoryMapIndex::_find(const QVector<INTERVAL> &listIntervals, quint64 nValue, qint32 nHint)
+{
+    qint32 nResult = -1;
+
+    if ((nHint >= 0) && (nHint < listIntervals.count()) && (listIntervals.at(nHint).nStart <= nValue) && (nValue < listIntervals.at(nHint).nEnd)) {
+        nResult = nHint;
+    } else {
+        qint32 nLow = 0;
+        qint32 nHigh = listIntervals.count();
+
+        while (nLow < nHigh) {
+            qint32 nMiddle = (nLow + nHigh) / 2;
+
+            if (listIntervals.at(nMiddle).nStart <= nValue) {
+                nLow = nMiddle + 1;
+            } else {
+                nHigh = nMiddle;
+            }
+        }
+
+        if ((nLow > 0) && (nValue < listIntervals.at(nLow - 1).nEnd)) {
+            nResult = nLow - 1;
+        }
+    }
+
+    return nResult;
+}
+
+qint64 XMemoryMapIndex::addressToOffset(XBinary::_MEMORY_MAP *pMemoryMap, XADDR nAddress, CURSOR *pCursor) const
+{
+    qint64 nResult = -1;
+
+    qint32 nIndex = _find(m_listAddressIntervals, nAddress, pCursor ? pCursor->nAddressIndex : -1);
+
+    if (nIndex != -1) {
+        const INTERVAL &interval = m_listAddressIntervals.at(nIndex);
+        nResult = (qint64)(interval.nTarget + (nAddress - interval.nStart));
+
+        if (pCursor) {
+            pCursor->nAddressIndex = nIndex;
+        }
+    } else {
+        nResult = XBinary::addressToOffset(pMemoryMap, nAddress);
+    }
+
+    return nResult;
+}
+
+XADDR XMemoryMapIndex::offsetToAddress(XBinary::_MEMORY_MAP *pMemoryMap, qint64 nOffset, CURSOR *pCursor) const
+{
+    XADDR nResult = (XADDR)-1;
+
+    qint32 nIndex = -1;
+
+    if (nOffset >= 0) {
+        nIndex = _find(m_listOffsetIntervals, (quint64)nOffset, pCursor ? pCursor->nOffsetIndex : -1);
+    }
+
+    if (nIndex != -1) {
+        const INTERVAL &interval = m_listOffsetIntervals.at(nIndex);
+        nResult = interval.nTarget + ((quint64)nOffset - interval.nStart);
+
+        if (pCursor) {
+            pCursor->nOffsetIndex = nIndex;
+        }
+    } else {
+        nResult = XBinary::offsetToAddress(pMemoryMap, nOffset);
+    }
+
+    return nResult;
+}
+
+bool XMemoryMapIndex::isOffsetValid(XBinary::_MEMORY_MAP *pMemoryMap, qint64 nOffset, CURSOR *pCursor) const
+{
+    bool bResult = false;
+
+    qint32 nIndex = -1;
+
+    if (nOffset >= 0) {
+        nIndex = _find(m_listOffsetIntervals, (quint64)nOffset, pCursor ? pCursor->nOffsetIndex : -1);
+    }
+
+    if (nIndex != -1) {
+        bResult = true;
+
+        if (pCursor) {
+            pCursor->nOffsetIndex = nIndex;
+        }
+    } else {
+        bResult = XBinary::isOffsetValid(pMemoryMap, nOffset);
+    }
+
+    return bResult;
+}
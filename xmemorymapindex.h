@@ -0,0 +1,71 @@
+/* Copyright (c) 2025-2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef XMEMORYMAPINDEX_H
+#define XMEMORYMAPINDEX_H
+
+#include "xbinary.h"
+
+// Sorted interval form of a _MEMORY_MAP for address/offset translation in decode loops. Overlapping records
+// are resolved once at build time (the first record wins, as in the linear XBinary lookups), so a query is a
+// binary search over disjoint intervals; the CURSOR keeps the last hit per caller for sequential access.
+// A built index is only read, so one instance can serve several threads.
+class XMemoryMapIndex {
+public:
+    struct CURSOR {
+        qint32 nAddressIndex;  // Last hit in the address intervals, -1 if none
+        qint32 nOffsetIndex;   // Last hit in the offset intervals, -1 if none
+    };
+
+    XMemoryMapIndex();
+
+    void build(const XBinary::_MEMORY_MAP *pMemoryMap);
+    bool isBuiltFor(const XBinary::_MEMORY_MAP *pMemoryMap) const;  // The map has the same records (addresses, offsets, sizes) as at build
+    static CURSOR getCursor();
+
+    // The cursor may be nullptr; misses fall back to the XBinary lookups, so the results are the same
+    qint64 addressToOffset(XBinary::_MEMORY_MAP *pMemoryMap, XADDR nAddress, CURSOR *pCursor) const;
+    XADDR offsetToAddress(XBinary::_MEMORY_MAP *pMemoryMap, qint64 nOffset, CURSOR *pCursor) const;
+    bool isOffsetValid(XBinary::_MEMORY_MAP *pMemoryMap, qint64 nOffset, CURSOR *pCursor) const;
+
+private:
+    struct INTERVAL {
+        quint64 nStart;
+        quint64 nEnd;     // Exclusive
+        quint64 nTarget;  // Offset (address intervals) or address (offset intervals) of nStart
+    };
+
+    static QVector<INTERVAL> _buildIntervals(const QList<INTERVAL> &listOrdered);
+    static qint32 _find(const QVector<INTERVAL> &listIntervals, quint64 nValue, qint32 nHint);
+
+    struct RECORD_KEY {
+        XADDR nAddress;
+        qint64 nOffset;
+        qint64 nSize;
+    };
+
+    QVector<RECORD_KEY> m_listRecordKeys;
+    qint64 m_nBinarySize;
+    QVector<INTERVAL> m_listAddressIntervals;
+    QVector<INTERVAL> m_listOffsetIntervals;
+};
+
+#endif  // XMEMORYMAPINDEX_H
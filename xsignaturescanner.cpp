@@ -0,0 +1,819 @@
+/* Copyright (c) 2025-2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "xsignaturescanner.h"
+
+#include <QtEndian>
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define XSIGNATURESCANNER_SSE2
+#endif
+
+const qint64 N_SCAN_MIN_CHUNK_SIZE = 0x100000;
+const qint32 N_INDEX_BUCKET_BITS = 20;
+const qint64 N_INDEX_MAX_POSITIONS = 0x1FFFFFFF;  // QVector<quint32> size limit
+
+// Lower is rarer in code; the anchor pair with the lowest sum is used
+static qint32 _getByteCommonness(quint8 nByte)
+{
+    qint32 nResult = 0;
+
+    if (nByte == 0x00) {
+        nResult = 3;
+    } else if (nByte == 0xFF) {
+        nResult = 2;
+    } else if ((nByte == 0xCC) || (nByte == 0x90) || (nByte == 0x8B) || (nByte == 0x89) || (nByte == 0x48)) {
+        nResult = 1;
+    }
+
+    return nResult;
+}
+
+// Both the data and the pattern have nSize readable bytes
+static bool _compareMasked(const char *pData, const char *pPattern, const char *pMask, qint32 nSize)
+{
+    qint32 i = 0;
+
+#ifdef XSIGNATURESCANNER_SSE2
+    for (; (i + 16) <= nSize; i += 16) {
+        __m128i data = _mm_loadu_si128((const __m128i *)(pData + i));
+        __m128i pattern = _mm_loadu_si128((const __m128i *)(pPattern + i));
+        __m128i mask = _mm_loadu_si128((const __m128i *)(pMask + i));
+        __m128i diff = _mm_and_si128(_mm_xor_si128(data, pattern), mask);
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xFFFF) {
+            return false;
+        }
+    }
+#endif
+
+    for (; i < nSize; i++) {
+        if ((pData[i] ^ pPattern[i]) & pMask[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static qint64 _readRel(const char *pData, qint32 nSize)
+{
+    qint64 nResult = 0;
+
+    if (nSize == 1) {
+        nResult = *(const qint8 *)pData;
+    } else if (nSize == 2) {
+        nResult = (qint16)qFromLittleEndian<quint16>((const uchar *)pData);
+    } else if (nSize == 4) {
+        nResult = (qint32)qFromLittleEndian<quint32>((const uchar *)pData);
+    } else if (nSize == 8) {
+        nResult = (qint64)qFromLittleEndian<quint64>((const uchar *)pData);
+    }
+
+    return nResult;
+}
+
+// Copies nSize bytes from offset nDelta of region nRegionIndex on through the following regions, as long as each one starts
+// where the previous ends; false if the address range has a gap
+static bool _readSpan(const QVector<XDisasmCore::MEMORY_REGION> &listRegions, qint32 nRegionIndex, qint64 nDelta, char *pBuffer, qint32 nSize)
+{
+    bool bResult = true;
+
+    qint32 nNumberOfRegions = listRegions.count();
+
+    while (bResult && (nSize > 0)) {
+        const XDisasmCore::MEMORY_REGION &region = listRegions.at(nRegionIndex);
+        qint32 nPartSize = (qint32)qMin((qint64)nSize, region.nSize - nDelta);
+
+        memcpy(pBuffer, region.pData + nDelta, nPartSize);
+
+        pBuffer += nPartSize;
+        nSize -= nPartSize;
+
+        if (nSize > 0) {
+            bResult = ((nRegionIndex + 1) < nNumberOfRegions) && (listRegions.at(nRegionIndex + 1).nAddress == (region.nAddress + region.nSize));
+            nRegionIndex++;
+            nDelta = 0;
+        }
+    }
+
+    return bResult;
+}
+
+class XSignatureScanTask : public QRunnable {
+public:
+    XSignatureScanTask(const XSignatureScanner *pScanner, const QVector<XDisasmCore::MEMORY_REGION> *pListRegions, qint32 nRegionIndex, qint64 nStart,
+                       qint64 nEnd, QVector<XSignatureScanner::MATCH> *pListMatches, XBinary::PDSTRUCT *pPdStruct)
+    {
+        m_pScanner = pScanner;
+        m_pListRegions = pListRegions;
+        m_nRegionIndex = nRegionIndex;
+        m_nStart = nStart;
+        m_nEnd = nEnd;
+        m_pListMatches = pListMatches;
+        m_pPdStruct = pPdStruct;
+    }
+
+    virtual void run()
+    {
+        if (XBinary::isPdStructNotCanceled(m_pPdStruct)) {
+            m_pScanner->scanChunk(*m_pListRegions, m_nRegionIndex, m_nStart, m_nEnd, m_pListMatches);
+        }
+    }
+
+private:
+    const XSignatureScanner *m_pScanner;
+    const QVector<XDisasmCore::MEMORY_REGION> *m_pListRegions;
+    qint32 m_nRegionIndex;
+    qint64 m_nStart;
+    qint64 m_nEnd;
+    QVector<XSignatureScanner::MATCH> *m_pListMatches;
+    XBinary::PDSTRUCT *m_pPdStruct;
+};
+
+XSignatureScanner::XSignatureScanner(QObject *pParent) : QObject(pParent)
+{
+    m_bIsCompiled = false;
+}
+
+void XSignatureScanner::clear()
+{
+    m_listSignatures.clear();
+    m_listPairBitmap.clear();
+    m_listPairBucketOffsets.clear();
+    m_listPairAnchors.clear();
+    m_listByteBucketOffsets.clear();
+    m_listByteAnchors.clear();
+    m_listUnanchored.clear();
+    m_bIsCompiled = false;
+}
+
+qint32 XSignatureScanner::addSignature(const XDisasmCore::SIGNATURE &signature)
+{
+    qint32 nResult = -1;
+
+    if (signature.baPattern.size() && (signature.baPattern.size() == signature.baMask.size())) {
+        nResult = m_listSignatures.count();
+        m_listSignatures.append(signature);
+        m_bIsCompiled = false;
+    }
+
+    return nResult;
+}
+
+qint32 XSignatureScanner::addSignature(const QString &sSignature)
+{
+    qint32 nResult = -1;
+
+    XDisasmCore::SIGNATURE signature;
+
+    if (XDisasmCore::stringToSignature(sSignature, &signature)) {
+        nResult = addSignature(signature);
+    }
+
+    return nResult;
+}
+
+void XSignatureScanner::compile()
+{
+    m_listPairBitmap.fill(0, 65536 / 64);
+    m_listPairBucketOffsets.fill(0, 65536 + 1);
+    m_listPairAnchors.clear();
+    m_listByteBucketOffsets.fill(0, 256 + 1);
+    m_listByteAnchors.clear();
+    m_listUnanchored.clear();
+
+    QVector<ANCHOR> listPairs;
+    QVector<quint16> listPairKeys;
+    QVector<ANCHOR> listBytes;
+    QVector<quint8> listByteKeys;
+
+    qint32 nNumberOfSignatures = m_listSignatures.count();
+
+    for (qint32 i = 0; i < nNumberOfSignatures; i++) {
+        const XDisasmCore::SIGNATURE &signature = m_listSignatures.at(i);
+        const quint8 *pPattern = (const quint8 *)signature.baPattern.constData();
+        const char *pMask = signature.baMask.constData();
+
+        // Only the bytes before the first rel field sit at a fixed distance from the match start
+        qint32 nSegmentSize = signature.baPattern.size();
+
+        if (signature.listRels.count()) {
+            nSegmentSize = signature.listRels.at(0).nOffset;
+        }
+
+        qint32 nPairOffset = -1;
+        qint32 nPairScore = 0;
+        qint32 nByteOffset = -1;
+        qint32 nByteScore = 0;
+
+        for (qint32 j = 0; j < nSegmentSize; j++) {
+            if (pMask[j]) {
+                qint32 nScore = _getByteCommonness(pPattern[j]);
+
+                if ((nByteOffset == -1) || (nScore < nByteScore)) {
+                    nByteOffset = j;
+                    nByteScore = nScore;
+                }
+
+                if (((j + 1) < nSegmentSize) && pMask[j + 1]) {
+                    nScore += _getByteCommonness(pPattern[j + 1]);
+
+                    if ((nPairOffset == -1) || (nScore < nPairScore)) {
+                        nPairOffset = j;
+                        nPairScore = nScore;
+                    }
+                }
+            }
+        }
+
+        if (nPairOffset != -1) {
+            ANCHOR anchor = {i, nPairOffset};
+            listPairs.append(anchor);
+            listPairKeys.append((quint16)(pPattern[nPairOffset] | (pPattern[nPairOffset + 1] << 8)));
+        } else if (nByteOffset != -1) {
+            ANCHOR anchor = {i, nByteOffset};
+            listBytes.append(anchor);
+            listByteKeys.append(pPattern[nByteOffset]);
+        } else {
+            m_listUnanchored.append(i);
+        }
+    }
+
+    // Bucket the anchors by key (CSR layout)
+    qint32 nNumberOfPairs = listPairs.count();
+
+    for (qint32 i = 0; i < nNumberOfPairs; i++) {
+        quint16 nKey = listPairKeys.at(i);
+
+        m_listPairBitmap[nKey / 64] |= ((quint64)1 << (nKey % 64));
+        m_listPairBucketOffsets[nKey + 1]++;
+    }
+
+    for (qint32 i = 0; i < 65536; i++) {
+        m_listPairBucketOffsets[i + 1] += m_listPairBucketOffsets.at(i);
+    }
+
+    m_listPairAnchors.resize(nNumberOfPairs);
+
+    QVector<qint32> listPositions = m_listPairBucketOffsets;
+
+    for (qint32 i = 0; i < nNumberOfPairs; i++) {
+        m_listPairAnchors[listPositions[listPairKeys.at(i)]++] = listPairs.at(i);
+    }
+
+    qint32 nNumberOfBytes = listBytes.count();
+
+    for (qint32 i = 0; i < nNumberOfBytes; i++) {
+        m_listByteBucketOffsets[listByteKeys.at(i) + 1]++;
+    }
+
+    for (qint32 i = 0; i < 256; i++) {
+        m_listByteBucketOffsets[i + 1] += m_listByteBucketOffsets.at(i);
+    }
+
+    m_listByteAnchors.resize(nNumberOfBytes);
+
+    listPositions = m_listByteBucketOffsets;
+
+    for (qint32 i = 0; i < nNumberOfBytes; i++) {
+        m_listByteAnchors[listPositions[listByteKeys.at(i)]++] = listBytes.at(i);
+    }
+
+    m_bIsCompiled = true;
+}
+
+qint32 XSignatureScanner::getNumberOfSignatures() const
+{
+    return m_listSignatures.count();
+}
+
+QVector<XSignatureScanner::MATCH> XSignatureScanner::scan(char *pData, qint64 nDataSize, XADDR nAddress, qint32 nNumberOfThreads,
+                                                          XBinary::PDSTRUCT *pPdStruct) const
+{
+    XDisasmCore::MEMORY_REGION region = {};
+    region.nAddress = nAddress;
+    region.nSize = nDataSize;
+    region.pData = pData;
+
+    QList<XDisasmCore::MEMORY_REGION> listRegions;
+    listRegions.append(region);
+
+    return scanRegions(listRegions, nNumberOfThreads, pPdStruct);
+}
+
+QVector<XSignatureScanner::MATCH> XSignatureScanner::scan(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, qint32 nNumberOfThreads,
+                                                          XBinary::PDSTRUCT *pPdStruct) const
+{
+    QVector<MATCH> listResult;
+
+    XDisasmCore::MAPPED_INPUT mappedInput = {};
+
+    if (XDisasmCore::mapInput(pDevice, pMemoryMap, &mappedInput)) {
+        listResult = scanRegions(mappedInput.listRegions, nNumberOfThreads, pPdStruct);
+    }
+
+    XDisasmCore::unmapInput(&mappedInput);
+
+    return listResult;
+}
+
+QVector<XSignatureScanner::MATCH> XSignatureScanner::scanRegions(const QList<XDisasmCore::MEMORY_REGION> &listRegions, qint32 nNumberOfThreads,
+                                                                 XBinary::PDSTRUCT *pPdStruct) const
+{
+    QVector<MATCH> listResult;
+
+    if (m_bIsCompiled && m_listSignatures.count()) {
+        QVector<XDisasmCore::MEMORY_REGION> listSorted = listRegions.toVector();
+
+        std::sort(listSorted.begin(), listSorted.end(),
+                  [](const XDisasmCore::MEMORY_REGION &a, const XDisasmCore::MEMORY_REGION &b) { return a.nAddress < b.nAddress; });
+
+        if (nNumberOfThreads <= 0) {
+            nNumberOfThreads = QThread::idealThreadCount();
+        }
+
+        nNumberOfThreads = qMax(nNumberOfThreads, 1);
+
+        qint64 nTotalSize = 0;
+        qint32 nNumberOfRegions = listSorted.count();
+
+        for (qint32 i = 0; i < nNumberOfRegions; i++) {
+            nTotalSize += listSorted.at(i).nSize;
+        }
+
+        qint64 nChunkSize = qMax(nTotalSize / (nNumberOfThreads * 4), N_SCAN_MIN_CHUNK_SIZE);
+
+        // Every anchor position belongs to exactly one chunk, so no match is reported twice
+        struct SCAN_CHUNK {
+            qint32 nRegionIndex;
+            qint64 nStart;
+            qint64 nEnd;
+        };
+
+        QVector<SCAN_CHUNK> listChunks;
+
+        for (qint32 i = 0; i < nNumberOfRegions; i++) {
+            for (qint64 nStart = 0; nStart < listSorted.at(i).nSize; nStart += nChunkSize) {
+                SCAN_CHUNK chunk = {i, nStart, qMin(nStart + nChunkSize, listSorted.at(i).nSize)};
+                listChunks.append(chunk);
+            }
+        }
+
+        qint32 nNumberOfChunks = listChunks.count();
+        QVector<QVector<MATCH>> listChunkMatches(nNumberOfChunks);
+
+        if ((nNumberOfThreads == 1) || (nNumberOfChunks == 1)) {
+            for (qint32 i = 0; (i < nNumberOfChunks) && XBinary::isPdStructNotCanceled(pPdStruct); i++) {
+                scanChunk(listSorted, listChunks.at(i).nRegionIndex, listChunks.at(i).nStart, listChunks.at(i).nEnd, &(listChunkMatches[i]));
+            }
+        } else {
+            QThreadPool threadPool;
+            threadPool.setMaxThreadCount(nNumberOfThreads);
+
+            for (qint32 i = 0; i < nNumberOfChunks; i++) {
+                threadPool.start(new XSignatureScanTask(this, &listSorted, listChunks.at(i).nRegionIndex, listChunks.at(i).nStart, listChunks.at(i).nEnd,
+                                                        &(listChunkMatches[i]), pPdStruct));
+            }
+
+            threadPool.waitForDone();
+        }
+
+        for (qint32 i = 0; i < nNumberOfChunks; i++) {
+            listResult += listChunkMatches.at(i);
+        }
+
+        std::sort(listResult.begin(), listResult.end(), [](const MATCH &a, const MATCH &b) {
+            return (a.nAddress < b.nAddress) || ((a.nAddress == b.nAddress) && (a.nSignature < b.nSignature));
+        });
+    }
+
+    return listResult;
+}
+
+bool XSignatureScanner::isMatch(qint32 nSignature, const QVector<XDisasmCore::MEMORY_REGION> &listRegions, XADDR nAddress) const
+{
+    bool bResult = false;
+
+    if ((nSignature >= 0) && (nSignature < m_listSignatures.count())) {
+        bResult = isSignatureMatch(m_listSignatures.at(nSignature), listRegions, nAddress);
+    }
+
+    return bResult;
+}
+
+bool XSignatureScanner::isSignatureMatch(const XDisasmCore::SIGNATURE &signature, const QVector<XDisasmCore::MEMORY_REGION> &listRegions, XADDR nAddress)
+{
+    const char *pPattern = signature.baPattern.constData();
+    const char *pMask = signature.baMask.constData();
+
+    qint32 nPatternSize = signature.baPattern.size();
+    qint32 nNumberOfRels = signature.listRels.count();
+    qint32 nPosition = 0;
+    XADDR nCurrentAddress = nAddress;
+
+    bool bResult = true;
+
+    // Segment by segment; after a rel field the next segment continues at the branch target
+    for (qint32 i = 0; bResult && (i <= nNumberOfRels); i++) {
+        qint32 nSegmentEnd = nPatternSize;
+        qint32 nRelSize = 0;
+
+        if (i < nNumberOfRels) {
+            nSegmentEnd = signature.listRels.at(i).nOffset;
+            nRelSize = signature.listRels.at(i).nSize;
+        }
+
+        qint32 nSegmentSize = nSegmentEnd - nPosition + nRelSize;
+        qint32 nRegionIndex = findRegion(listRegions, nCurrentAddress);
+
+        bResult = false;
+
+        if (nRegionIndex != -1) {
+            const XDisasmCore::MEMORY_REGION &region = listRegions.at(nRegionIndex);
+            qint64 nDelta = (qint64)(nCurrentAddress - region.nAddress);
+
+            const char *pData = nullptr;
+            QByteArray baSpan;
+
+            if ((region.nSize - nDelta) >= nSegmentSize) {
+                pData = region.pData + nDelta;
+            } else {
+                // The segment runs on into the next region(s); rare, so it is copied
+                baSpan.resize(nSegmentSize);
+
+                if (_readSpan(listRegions, nRegionIndex, nDelta, baSpan.data(), nSegmentSize)) {
+                    pData = baSpan.constData();
+                }
+            }
+
+            if (pData) {
+                bResult = _compareMasked(pData, pPattern + nPosition, pMask + nPosition, nSegmentEnd - nPosition);
+
+                if (bResult && nRelSize) {
+                    nCurrentAddress += nSegmentSize;
+                    nCurrentAddress += _readRel(pData + (nSegmentEnd - nPosition), nRelSize);
+                }
+            }
+        }
+
+        nPosition = nSegmentEnd + nRelSize;
+    }
+
+    return bResult;
+}
+
+qint32 XSignatureScanner::findRegion(const QVector<XDisasmCore::MEMORY_REGION> &listRegions, XADDR nAddress)
+{
+    qint32 nResult = -1;
+
+    qint32 nLow = 0;
+    qint32 nHigh = listRegions.count();
+
+    while (nLow < nHigh) {
+        qint32 nMiddle = (nLow + nHigh) / 2;
+
+        if (listRegions.at(nMiddle).nAddress <= nAddress) {
+            nLow = nMiddle + 1;
+        } else {
+            nHigh = nMiddle;
+        }
+    }
+
+    if (nLow > 0) {
+        const XDisasmCore::MEMORY_REGION &region = listRegions.at(nLow - 1);
+
+        if ((qint64)(nAddress - region.nAddress) < region.nSize) {
+            nResult = nLow - 1;
+        }
+    }
+
+    return nResult;
+}
+
+void XSignatureScanner::scanChunk(const QVector<XDisasmCore::MEMORY_REGION> &listRegions, qint32 nRegionIndex, qint64 nStart, qint64 nEnd,
+                                  QVector<MATCH> *pListMatches) const
+{
+    const XDisasmCore::MEMORY_REGION &region = listRegions.at(nRegionIndex);
+    const quint8 *pData = (const quint8 *)region.pData;
+    const quint64 *pPairBitmap = m_listPairBitmap.constData();
+    const qint32 *pPairOffsets = m_listPairBucketOffsets.constData();
+    const qint32 *pByteOffsets = m_listByteBucketOffsets.constData();
+    qint32 nNumberOfUnanchored = m_listUnanchored.count();
+    bool bIsBytes = (m_listByteAnchors.count() > 0);
+
+    // A pair anchor on the last byte takes its second byte from the next region if the addresses continue there
+    bool bIsNextByte = false;
+    quint8 nNextByte = 0;
+
+    if ((nRegionIndex + 1) < listRegions.count()) {
+        const XDisasmCore::MEMORY_REGION &regionNext = listRegions.at(nRegionIndex + 1);
+
+        if ((regionNext.nAddress == (region.nAddress + region.nSize)) && (regionNext.nSize > 0)) {
+            bIsNextByte = true;
+            nNextByte = *(const quint8 *)regionNext.pData;
+        }
+    }
+
+    for (qint64 i = nStart; i < nEnd; i++) {
+        // i is the position of the anchor; the match starts nOffset bytes before it, possibly in the previous region
+        XADDR nAnchorAddress = region.nAddress + i;
+
+        if (((i + 1) < region.nSize) || bIsNextByte) {
+            quint32 nKey = pData[i] | ((((i + 1) < region.nSize) ? pData[i + 1] : nNextByte) << 8);
+
+            if (pPairBitmap[nKey / 64] & ((quint64)1 << (nKey % 64))) {
+                for (qint32 j = pPairOffsets[nKey]; j < pPairOffsets[nKey + 1]; j++) {
+                    const ANCHOR &anchor = m_listPairAnchors.at(j);
+
+                    if (nAnchorAddress >= (XADDR)anchor.nOffset) {
+                        XADDR nAddress = nAnchorAddress - anchor.nOffset;
+
+                        if (isMatch(anchor.nSignature, listRegions, nAddress)) {
+                            MATCH match = {anchor.nSignature, nAddress};
+                            pListMatches->append(match);
+                        }
+                    }
+                }
+            }
+        }
+
+        if (bIsBytes) {
+            quint8 nByte = pData[i];
+
+            for (qint32 j = pByteOffsets[nByte]; j < pByteOffsets[nByte + 1]; j++) {
+                const ANCHOR &anchor = m_listByteAnchors.at(j);
+
+                if (nAnchorAddress >= (XADDR)anchor.nOffset) {
+                    XADDR nAddress = nAnchorAddress - anchor.nOffset;
+
+                    if (isMatch(anchor.nSignature, listRegions, nAddress)) {
+                        MATCH match = {anchor.nSignature, nAddress};
+                        pListMatches->append(match);
+                    }
+                }
+            }
+        }
+
+        for (qint32 j = 0; j < nNumberOfUnanchored; j++) {
+            if (isMatch(m_listUnanchored.at(j), listRegions, nAnchorAddress)) {
+                MATCH match = {m_listUnanchored.at(j), nAnchorAddress};
+                pListMatches->append(match);
+            }
+        }
+    }
+}
+
+static quint32 _getGramBucket(quint32 nGram)
+{
+    return (nGram * 2654435761U) >> (32 - N_INDEX_BUCKET_BITS);
+}
+
+XSignatureIndex::XSignatureIndex(XDisasmCore *pDisasmCore, QObject *pParent) : QObject(pParent)
+{
+    m_pDisasmCore = pDisasmCore;
+    m_pDevice = nullptr;
+    m_pMemoryMap = nullptr;
+    m_mappedInput = XDisasmCore::MAPPED_INPUT();
+}
+
+XSignatureIndex::~XSignatureIndex()
+{
+    clear();
+}
+
+bool XSignatureIndex::build(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, XBinary::PDSTRUCT *pPdStruct)
+{
+    clear();
+
+    bool bResult = false;
+
+    if (XDisasmCore::mapInput(pDevice, pMemoryMap, &m_mappedInput)) {
+        m_pDevice = pDevice;
+        m_pMemoryMap = pMemoryMap;
+        m_listRegions = m_mappedInput.listRegions.toVector();
+
+        std::sort(m_listRegions.begin(), m_listRegions.end(),
+                  [](const XDisasmCore::MEMORY_REGION &a, const XDisasmCore::MEMORY_REGION &b) { return a.nAddress < b.nAddress; });
+
+        qint32 nNumberOfRegions = m_listRegions.count();
+        qint64 nTotalSize = 0;
+
+        m_listRegionPositions.resize(nNumberOfRegions);
+
+        for (qint32 i = 0; i < nNumberOfRegions; i++) {
+            m_listRegionPositions[i] = (quint32)qMin(nTotalSize, N_INDEX_MAX_POSITIONS);
+            nTotalSize += m_listRegions.at(i).nSize;
+        }
+
+        if (nTotalSize <= N_INDEX_MAX_POSITIONS) {
+            m_listBucketOffsets.fill(0, (1 << N_INDEX_BUCKET_BITS) + 1);
+
+            // Counting sort of every byte position by the 4 bytes starting there: count, then place. Positions are
+            // visited in address order, so every bucket stays sorted by address.
+            for (qint32 i = 0; (i < nNumberOfRegions) && XBinary::isPdStructNotCanceled(pPdStruct); i++) {
+                const XDisasmCore::MEMORY_REGION &region = m_listRegions.at(i);
+
+                for (qint64 j = 0; (j + 4) <= region.nSize; j++) {
+                    m_listBucketOffsets[_getGramBucket(qFromLittleEndian<quint32>((const uchar *)(region.pData + j))) + 1]++;
+                }
+            }
+
+            for (qint32 i = 0; i < (1 << N_INDEX_BUCKET_BITS); i++) {
+                m_listBucketOffsets[i + 1] += m_listBucketOffsets.at(i);
+            }
+
+            m_listPositions.resize(m_listBucketOffsets.at(1 << N_INDEX_BUCKET_BITS));
+
+            QVector<qint32> listNext = m_listBucketOffsets;
+
+            for (qint32 i = 0; (i < nNumberOfRegions) && XBinary::isPdStructNotCanceled(pPdStruct); i++) {
+                const XDisasmCore::MEMORY_REGION &region = m_listRegions.at(i);
+                quint32 nRegionPosition = m_listRegionPositions.at(i);
+
+                for (qint64 j = 0; (j + 4) <= region.nSize; j++) {
+                    quint32 nBucket = _getGramBucket(qFromLittleEndian<quint32>((const uchar *)(region.pData + j)));
+                    m_listPositions[listNext[nBucket]++] = nRegionPosition + (quint32)j;
+                }
+            }
+
+            bResult = XBinary::isPdStructNotCanceled(pPdStruct);
+        }
+    }
+
+    if (!bResult) {
+        clear();
+    }
+
+    return bResult;
+}
+
+void XSignatureIndex::clear()
+{
+    XDisasmCore::unmapInput(&m_mappedInput);
+
+    m_pDevice = nullptr;
+    m_pMemoryMap = nullptr;
+    m_listRegions.clear();
+    m_listRegionPositions.clear();
+    m_listBucketOffsets.clear();
+    m_listPositions.clear();
+}
+
+qint32 XSignatureIndex::getNumberOfPositions() const
+{
+    return m_listPositions.count();
+}
+
+XADDR XSignatureIndex::_getAddress(quint32 nPosition) const
+{
+    // The last region that starts at or before the position
+    qint32 nIndex = (qint32)(std::upper_bound(m_listRegionPositions.constBegin(), m_listRegionPositions.constEnd(), nPosition) -
+                             m_listRegionPositions.constBegin()) -
+                    1;
+
+    return m_listRegions.at(nIndex).nAddress + (nPosition - m_listRegionPositions.at(nIndex));
+}
+
+qint32 XSignatureIndex::countMatches(const XDisasmCore::SIGNATURE &signature, const QVector<qint32> &listInstructionOffsets, XADDR nExclude,
+                                     qint32 nLimit) const
+{
+    qint32 nResult = 0;
+
+    if (!m_listBucketOffsets.isEmpty()) {
+        const char *pPattern = signature.baPattern.constData();
+        const char *pMask = signature.baMask.constData();
+
+        qint32 nSegmentSize = signature.baPattern.size();
+
+        if (signature.listRels.count()) {
+            nSegmentSize = signature.listRels.at(0).nOffset;
+        }
+
+        // The instruction of the first segment whose 4 leading bytes are fixed and whose bucket is the smallest
+        qint32 nBestOffset = -1;
+        quint32 nBestGram = 0;
+        qint32 nBestCount = 0;
+        qint32 nNumberOfOffsets = listInstructionOffsets.count();
+
+        for (qint32 i = 0; i < nNumberOfOffsets; i++) {
+            qint32 nOffset = listInstructionOffsets.at(i);
+
+            if ((nOffset + 4) <= nSegmentSize) {
+                if (pMask[nOffset] && pMask[nOffset + 1] && pMask[nOffset + 2] && pMask[nOffset + 3]) {
+                    quint32 nGram = qFromLittleEndian<quint32>((const uchar *)(pPattern + nOffset));
+                    quint32 nBucket = _getGramBucket(nGram);
+                    qint32 nCount = m_listBucketOffsets.at(nBucket + 1) - m_listBucketOffsets.at(nBucket);
+
+                    if ((nBestOffset == -1) || (nCount < nBestCount)) {
+                        nBestOffset = nOffset;
+                        nBestGram = nGram;
+                        nBestCount = nCount;
+                    }
+                }
+            }
+        }
+
+        qint32 nFirst = 0;
+        qint32 nLast = m_listPositions.count();
+
+        if (nBestOffset != -1) {
+            quint32 nBucket = _getGramBucket(nBestGram);
+            nFirst = m_listBucketOffsets.at(nBucket);
+            nLast = m_listBucketOffsets.at(nBucket + 1);
+        } else {
+            nBestOffset = 0;  // No fixed prefix: every indexed position is a candidate
+        }
+
+        for (qint32 i = nFirst; (i < nLast) && (nResult < nLimit); i++) {
+            XADDR nAddress = _getAddress(m_listPositions.at(i)) - nBestOffset;
+
+            if ((nAddress != nExclude) && XSignatureScanner::isSignatureMatch(signature, m_listRegions, nAddress)) {
+                nResult++;
+            }
+        }
+    }
+
+    return nResult;
+}
+
+XDisasmCore::SIGNATURE XSignatureIndex::getSignaturePrefix(const XDisasmCore::SIGNATURE &signature, const QVector<qint32> &listInstructionOffsets,
+                                                           qint32 nCount)
+{
+    XDisasmCore::SIGNATURE result;
+
+    qint32 nSize = signature.baPattern.size();
+
+    if (nCount < listInstructionOffsets.count()) {
+        nSize = listInstructionOffsets.at(nCount);
+    }
+
+    result.baPattern = signature.baPattern.left(nSize);
+    result.baMask = signature.baMask.left(nSize);
+
+    qint32 nNumberOfRels = signature.listRels.count();
+
+    for (qint32 i = 0; i < nNumberOfRels; i++) {
+        if (signature.listRels.at(i).nOffset < nSize) {
+            result.listRels.append(signature.listRels.at(i));
+        }
+    }
+
+    return result;
+}
+
+bool XSignatureIndex::getUniqueSignature(XADDR nAddress, XDisasmCore::ST signatureType, qint32 nMaxCount, XDisasmCore::SIGNATURE *pSignature)
+{
+    bool bResult = false;
+
+    *pSignature = XDisasmCore::SIGNATURE();
+
+    if (m_pDevice) {
+        QVector<qint32> listInstructionOffsets;
+        XDisasmCore::SIGNATURE signature = m_pDisasmCore->getSignatureData(m_pDevice, m_pMemoryMap, nAddress, signatureType, nMaxCount, &listInstructionOffsets);
+
+        qint32 nNumberOfInstructions = listInstructionOffsets.count();
+
+        // More instructions never add matches, so the shortest unique prefix is found by binary search
+        if (nNumberOfInstructions && (countMatches(signature, listInstructionOffsets, nAddress, 1) == 0)) {
+            qint32 nLow = 1;
+            qint32 nHigh = nNumberOfInstructions;
+
+            while (nLow < nHigh) {
+                qint32 nMiddle = (nLow + nHigh) / 2;
+
+                if (countMatches(getSignaturePrefix(signature, listInstructionOffsets, nMiddle), listInstructionOffsets.mid(0, nMiddle), nAddress, 1) == 0) {
+                    nHigh = nMiddle;
+                } else {
+                    nLow = nMiddle + 1;
+                }
+            }
+
+            *pSignature = getSignaturePrefix(signature, listInstructionOffsets, nLow);
+            bResult = true;
+        }
+    }
+
+    return bResult;
+}
@@ -0,0 +1,115 @@
+/* Copyright (c) 2025-2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef XSIGNATURESCANNER_H
+#define XSIGNATURESCANNER_H
+
+#include "xdisasmcore.h"
+
+// Multi-pattern matcher for masked signatures (ST_FULL/ST_MASK, and ST_REL with '$' fields that continue at the
+// branch target). compile() picks one anchor byte pair per signature; the scan looks every position up in a
+// 64K-bit pair bitmap and only verifies the signatures bucketed under a hit. Verification compares 16 bytes at a
+// time with SSE2 where available. Scans are split into chunks over a thread pool.
+class XSignatureScanner : public QObject {
+    Q_OBJECT
+
+public:
+    struct MATCH {
+        qint32 nSignature;  // Index from addSignature
+        XADDR nAddress;
+    };
+
+    explicit XSignatureScanner(QObject *pParent = nullptr);
+
+    void clear();
+    qint32 addSignature(const XDisasmCore::SIGNATURE &signature);  // Index of the signature, -1 if it is empty
+    qint32 addSignature(const QString &sSignature);                // Text form, see XDisasmCore::stringToSignature
+    void compile();                                                 // Required after adding signatures
+    qint32 getNumberOfSignatures() const;
+
+    // nNumberOfThreads 0: QThread::idealThreadCount. Matches are sorted by address, then by signature.
+    QVector<MATCH> scan(char *pData, qint64 nDataSize, XADDR nAddress, qint32 nNumberOfThreads = 0, XBinary::PDSTRUCT *pPdStruct = 0) const;
+    QVector<MATCH> scan(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, qint32 nNumberOfThreads = 0, XBinary::PDSTRUCT *pPdStruct = 0) const;
+    QVector<MATCH> scanRegions(const QList<XDisasmCore::MEMORY_REGION> &listRegions, qint32 nNumberOfThreads = 0, XBinary::PDSTRUCT *pPdStruct = 0) const;
+    // listRegions sorted by address; ST_REL fields are followed through them, and a segment may run on into the next region if
+    // that one starts right where the previous ends
+    bool isMatch(qint32 nSignature, const QVector<XDisasmCore::MEMORY_REGION> &listRegions, XADDR nAddress) const;
+    static bool isSignatureMatch(const XDisasmCore::SIGNATURE &signature, const QVector<XDisasmCore::MEMORY_REGION> &listRegions, XADDR nAddress);
+    static qint32 findRegion(const QVector<XDisasmCore::MEMORY_REGION> &listRegions, XADDR nAddress);  // -1 if none contains nAddress
+    // Matches whose anchor lies in [nStart, nEnd) of region nRegionIndex (the match itself may cross into address-contiguous
+    // neighbours); one unit of work of scanRegions
+    void scanChunk(const QVector<XDisasmCore::MEMORY_REGION> &listRegions, qint32 nRegionIndex, qint64 nStart, qint64 nEnd,
+                   QVector<MATCH> *pListMatches) const;
+
+private:
+    struct ANCHOR {
+        qint32 nSignature;
+        qint32 nOffset;  // Of the anchor inside the signature
+    };
+
+    QVector<XDisasmCore::SIGNATURE> m_listSignatures;
+    QVector<quint64> m_listPairBitmap;        // 65536 bits, bit (b0 | b1 << 8) set if a pair anchor starts with b0 b1
+    QVector<qint32> m_listPairBucketOffsets;  // 65537 offsets into m_listPairAnchors
+    QVector<ANCHOR> m_listPairAnchors;
+    QVector<qint32> m_listByteBucketOffsets;  // 257 offsets into m_listByteAnchors: signatures with a single fixed byte
+    QVector<ANCHOR> m_listByteAnchors;
+    QVector<qint32> m_listUnanchored;  // No fixed byte before the first rel field: verified everywhere
+    bool m_bIsCompiled;
+};
+
+// File-wide uniqueness index for signature generation: every byte position of every region, bucketed by a hash
+// of the 4 bytes starting there (CSR layout, 4 bytes per mapped byte). A candidate signature is checked against
+// the bucket of its rarest fixed 4-byte instruction prefix only, misaligned positions included, so the shortest
+// unique signature of an address is found by a binary search over the instruction count without rescanning the image.
+class XSignatureIndex : public QObject {
+    Q_OBJECT
+
+public:
+    explicit XSignatureIndex(XDisasmCore *pDisasmCore, QObject *pParent = nullptr);
+    ~XSignatureIndex();
+
+    // pDevice and pMemoryMap must outlive the index; false if the mapped input exceeds 512 MB
+    bool build(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, XBinary::PDSTRUCT *pPdStruct = 0);
+    void clear();
+    qint32 getNumberOfPositions() const;
+
+    // Matches at byte positions other than nExclude, counted up to nLimit
+    qint32 countMatches(const XDisasmCore::SIGNATURE &signature, const QVector<qint32> &listInstructionOffsets, XADDR nExclude, qint32 nLimit) const;
+    // Shortest prefix of at most nMaxCount instructions at nAddress that matches exactly once in the mapped input (at nAddress);
+    // false if even nMaxCount is not unique
+    bool getUniqueSignature(XADDR nAddress, XDisasmCore::ST signatureType, qint32 nMaxCount, XDisasmCore::SIGNATURE *pSignature);
+    static XDisasmCore::SIGNATURE getSignaturePrefix(const XDisasmCore::SIGNATURE &signature, const QVector<qint32> &listInstructionOffsets,
+                                                     qint32 nCount);
+
+private:
+    XADDR _getAddress(quint32 nPosition) const;
+
+    XDisasmCore *m_pDisasmCore;
+    QIODevice *m_pDevice;
+    XBinary::_MEMORY_MAP *m_pMemoryMap;
+    XDisasmCore::MAPPED_INPUT m_mappedInput;
+    QVector<XDisasmCore::MEMORY_REGION> m_listRegions;  // Sorted by address
+    QVector<quint32> m_listRegionPositions;             // Position of the first byte of every region; positions count mapped bytes
+    QVector<qint32> m_listBucketOffsets;
+    QVector<quint32> m_listPositions;
+};
+
+#endif  // XSIGNATURESCANNER_H